@@ -0,0 +1,44 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/csv_logger/csv_logger.h"
+
+// Measures how fast csv_logger turns rows of decoded values into text
+int main(int argc, const char *argv[]) {
+    const size_t columns = argc > 1 ? std::stoul(argv[1]) : 128;
+    const size_t rows = argc > 2 ? std::stoul(argv[2]) : 100000;
+
+    std::vector<std::string> header(columns + 1, "channel");
+    std::vector<std::vector<float>> samples(64, std::vector<float>(columns));
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    // Typical formula outputs such as 100/255*A
+    for (std::vector<float> &row : samples) {
+        for (float &v : row) {
+            v = 100.0f / 255.0f * byte(rng);
+        }
+    }
+
+    for (int precision : { -1, 2 }) {
+        obd2_server::csv_logger logger(header, "/dev/null");
+        logger.set_precisions(std::vector<int>(columns, precision));
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < rows; i++) {
+            logger.write_row(samples[i % samples.size()]);
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double values_per_s = double(rows * columns) / elapsed.count();
+
+        std::cout << "precision " << precision << ": " << rows << " rows x " << columns << " columns in " 
+            << elapsed.count() << " s (" << values_per_s / 1e6 << " M values/s)" << std::endl;
+    }
+
+    return 0;
+}
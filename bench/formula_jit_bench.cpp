@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/formula/formula.h"
+#include "../src/formula_jit/formula_jit.h"
+
+// Compares decoding single responses with the interpreter and with jit compiled formulas
+int main(int argc, const char *argv[]) {
+    const size_t samples = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::vector<std::string> expressions = {
+        "A-40",
+        "100/255*A",
+        "(256*A+B)/4",
+        "((A*256)+B)/32768*4-2",
+        "0.079*(256*A+B)*(C-125)/(D+1)",
+        "-(A*B)+C/7-(D-E)*0.5"
+    };
+
+    std::vector<uint8_t> payloads(samples * 8);
+    std::vector<uint8_t> lengths(samples);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    for (size_t i = 0; i < samples; i++) {
+        for (size_t k = 0; k < 8; k++) {
+            payloads[i * 8 + k] = uint8_t(byte(rng));
+        }
+
+        // Some responses are too short for the longer formulas
+        lengths[i] = uint8_t(byte(rng) < 8 ? byte(rng) % 5 : 8);
+    }
+
+    obd2_server::formula_jit jit;
+
+    for (const std::string &expression : expressions) {
+        obd2_server::formula interpreted(expression);
+        obd2_server::formula compiled(expression);
+        obd2_server::formula::native_decoder native = jit.compile({ &compiled }).front();
+
+        if (native == nullptr) {
+            std::cout << expression << ": not compiled" << std::endl;
+            continue;
+        }
+
+        compiled.set_native(native);
+
+        double seconds[2];
+        float sums[2];
+        const obd2_server::formula *variants[2] = { &interpreted, &compiled };
+        size_t mismatches = 0;
+
+        for (int v = 0; v < 2; v++) {
+            float sum = 0;
+            auto start = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i < samples; i++) {
+                float value = variants[v]->evaluate(&payloads[i * 8], lengths[i]);
+                sum += value == value ? value : 0;
+            }
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            seconds[v] = elapsed.count();
+            sums[v] = sum;
+        }
+
+        for (size_t i = 0; i < samples; i++) {
+            float a = interpreted.evaluate(&payloads[i * 8], lengths[i]);
+            float b = compiled.evaluate(&payloads[i * 8], lengths[i]);
+
+            if (std::memcmp(&a, &b, sizeof(float)) != 0) {
+                mismatches++;
+            }
+        }
+
+        std::cout << expression << ": interpreter " << samples / seconds[0] / 1e6 << " M/s, jit " 
+            << samples / seconds[1] / 1e6 << " M/s (" << seconds[0] / seconds[1] << "x), "
+            << mismatches << " mismatches" << (sums[0] == sums[1] ? "" : ", checksums differ") << std::endl;
+    }
+
+    return 0;
+}
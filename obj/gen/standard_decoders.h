@@ -0,0 +1,1722 @@
+// Generated from obd_standard.json by tools/gen_standard_decoders, do not edit
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+namespace obd2_server::standard_decoders {
+    using decode_fn = float (*)(const uint8_t *data, size_t size);
+
+    // CHANNEL tells apart the values of a PID in definition order
+    template <uint8_t PID, size_t CHANNEL>
+    constexpr float decode(const uint8_t *data, size_t size);
+
+    // 256*B+A
+    template <>
+    constexpr float decode<0x03, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((256.0f * float(data[1])) + float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x04, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // A-40
+    template <>
+    constexpr float decode<0x05, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) - 40.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x06, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x07, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x08, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x09, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 3*A
+    template <>
+    constexpr float decode<0x0a, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (3.0f * float(data[0]));
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x0b, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // (256*A+B)/4
+    template <>
+    constexpr float decode<0x0c, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 4.0f);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x0d, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // A/2-64
+    template <>
+    constexpr float decode<0x0e, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((float(data[0]) / 2.0f) - 64.0f);
+    }
+
+    // A-40
+    template <>
+    constexpr float decode<0x0f, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) - 40.0f);
+    }
+
+    // (256*A+B)/100
+    template <>
+    constexpr float decode<0x10, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 100.0f);
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x11, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x12, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x13, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x14, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x14, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x15, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x15, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x16, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x16, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x17, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x17, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x18, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x18, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x19, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x19, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x1a, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x1a, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A/200
+    template <>
+    constexpr float decode<0x1b, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) / 200.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x1b, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x1c, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x1d, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x1e, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // 256*A+B
+    template <>
+    constexpr float decode<0x1f, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((256.0f * float(data[0])) + float(data[1]));
+    }
+
+    // 256*A+B
+    template <>
+    constexpr float decode<0x21, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((256.0f * float(data[0])) + float(data[1]));
+    }
+
+    // (256*A+B)*0.079
+    template <>
+    constexpr float decode<0x22, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) * 0.079f);
+    }
+
+    // (256*A+B)*10
+    template <>
+    constexpr float decode<0x23, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) * 10.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x24, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x24, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x25, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x25, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x26, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x26, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x27, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x27, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x28, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x28, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x29, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x29, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x2a, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x2a, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x2b, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/8192
+    template <>
+    constexpr float decode<0x2b, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[2])) + float(data[3])) / 8192.0f);
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x2c, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/128*A-128
+    template <>
+    constexpr float decode<0x2d, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 128.0f);
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x2e, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x2f, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x30, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // 256*A+B
+    template <>
+    constexpr float decode<0x31, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((256.0f * float(data[0])) + float(data[1]));
+    }
+
+    // 256*A+B-32767
+    template <>
+    constexpr float decode<0x32, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) - 32767.0f);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x33, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x34, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x34, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x35, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x35, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x36, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x36, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x37, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x37, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x38, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x38, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x39, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x39, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x3a, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x3a, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x3b, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // (256*C+D)/256-128
+    template <>
+    constexpr float decode<0x3b, 1>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[2])) + float(data[3])) / 256.0f) - 128.0f);
+    }
+
+    // (256*A+B)/10-40
+    template <>
+    constexpr float decode<0x3c, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[0])) + float(data[1])) / 10.0f) - 40.0f);
+    }
+
+    // (256*A+B)/10-40
+    template <>
+    constexpr float decode<0x3d, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[0])) + float(data[1])) / 10.0f) - 40.0f);
+    }
+
+    // (256*A+B)/10-40
+    template <>
+    constexpr float decode<0x3e, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[0])) + float(data[1])) / 10.0f) - 40.0f);
+    }
+
+    // (256*A+B)/10-40
+    template <>
+    constexpr float decode<0x3f, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[0])) + float(data[1])) / 10.0f) - 40.0f);
+    }
+
+    // (256*A+B)/1000
+    template <>
+    constexpr float decode<0x42, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 1000.0f);
+    }
+
+    // 100/255*(256*A+B)
+    template <>
+    constexpr float decode<0x43, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * ((256.0f * float(data[0])) + float(data[1])));
+    }
+
+    // (256*A+B)/32768
+    template <>
+    constexpr float decode<0x44, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 32768.0f);
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x45, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // A-40
+    template <>
+    constexpr float decode<0x46, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) - 40.0f);
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x47, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x48, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x49, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x4a, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x4b, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x4c, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 256*A+B
+    template <>
+    constexpr float decode<0x4d, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((256.0f * float(data[0])) + float(data[1]));
+    }
+
+    // 256*A+B
+    template <>
+    constexpr float decode<0x4e, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((256.0f * float(data[0])) + float(data[1]));
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x4f, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // B
+    template <>
+    constexpr float decode<0x4f, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[1]);
+    }
+
+    // C
+    template <>
+    constexpr float decode<0x4f, 2>(const uint8_t *data, size_t size) {
+        if (size < 3) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[2]);
+    }
+
+    // D*10
+    template <>
+    constexpr float decode<0x4f, 3>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[3]) * 10.0f);
+    }
+
+    // A*10
+    template <>
+    constexpr float decode<0x50, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) * 10.0f);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x51, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x52, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // (256*A+B)/200
+    template <>
+    constexpr float decode<0x53, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 200.0f);
+    }
+
+    // 256*A+B-32767
+    template <>
+    constexpr float decode<0x54, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) - 32767.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x55, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x55, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x56, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x56, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x57, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x57, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // 100/128*A-100
+    template <>
+    constexpr float decode<0x58, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[0])) - 100.0f);
+    }
+
+    // 100/128*B-100
+    template <>
+    constexpr float decode<0x58, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((100.0f / 128.0f) * float(data[1])) - 100.0f);
+    }
+
+    // (256*A+B)*10
+    template <>
+    constexpr float decode<0x59, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) * 10.0f);
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x5a, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // 100/255*A
+    template <>
+    constexpr float decode<0x5b, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((100.0f / 255.0f) * float(data[0]));
+    }
+
+    // A-40
+    template <>
+    constexpr float decode<0x5c, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) - 40.0f);
+    }
+
+    // (256*A+B)/128-210
+    template <>
+    constexpr float decode<0x5d, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((((256.0f * float(data[0])) + float(data[1])) / 128.0f) - 210.0f);
+    }
+
+    // (256*A+B)/20
+    template <>
+    constexpr float decode<0x5e, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (((256.0f * float(data[0])) + float(data[1])) / 20.0f);
+    }
+
+    // A
+    template <>
+    constexpr float decode<0x5f, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return float(data[0]);
+    }
+
+    // A-125
+    template <>
+    constexpr float decode<0x61, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) - 125.0f);
+    }
+
+    // A-125
+    template <>
+    constexpr float decode<0x62, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) - 125.0f);
+    }
+
+    // 256*A+B
+    template <>
+    constexpr float decode<0x63, 0>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return ((256.0f * float(data[0])) + float(data[1]));
+    }
+
+    // A-125
+    template <>
+    constexpr float decode<0x64, 0>(const uint8_t *data, size_t size) {
+        if (size < 1) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[0]) - 125.0f);
+    }
+
+    // B-125
+    template <>
+    constexpr float decode<0x64, 1>(const uint8_t *data, size_t size) {
+        if (size < 2) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[1]) - 125.0f);
+    }
+
+    // C-125
+    template <>
+    constexpr float decode<0x64, 2>(const uint8_t *data, size_t size) {
+        if (size < 3) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[2]) - 125.0f);
+    }
+
+    // D-125
+    template <>
+    constexpr float decode<0x64, 3>(const uint8_t *data, size_t size) {
+        if (size < 4) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[3]) - 125.0f);
+    }
+
+    // E-125
+    template <>
+    constexpr float decode<0x64, 4>(const uint8_t *data, size_t size) {
+        if (size < 5) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return (float(data[4]) - 125.0f);
+    }
+
+    struct entry {
+        std::string_view formula;
+        decode_fn decode;
+    };
+
+    // Decoders ordered by PID
+    inline constexpr std::array<entry, 129> ENTRIES = {{
+        { "256*B+A", decode<0x03, 0> },
+        { "100/255*A", decode<0x04, 0> },
+        { "A-40", decode<0x05, 0> },
+        { "100/128*A-100", decode<0x06, 0> },
+        { "100/128*A-100", decode<0x07, 0> },
+        { "100/128*A-100", decode<0x08, 0> },
+        { "100/128*A-100", decode<0x09, 0> },
+        { "3*A", decode<0x0a, 0> },
+        { "A", decode<0x0b, 0> },
+        { "(256*A+B)/4", decode<0x0c, 0> },
+        { "A", decode<0x0d, 0> },
+        { "A/2-64", decode<0x0e, 0> },
+        { "A-40", decode<0x0f, 0> },
+        { "(256*A+B)/100", decode<0x10, 0> },
+        { "100/255*A", decode<0x11, 0> },
+        { "A", decode<0x12, 0> },
+        { "A", decode<0x13, 0> },
+        { "A/200", decode<0x14, 0> },
+        { "100/128*B-100", decode<0x14, 1> },
+        { "A/200", decode<0x15, 0> },
+        { "100/128*B-100", decode<0x15, 1> },
+        { "A/200", decode<0x16, 0> },
+        { "100/128*B-100", decode<0x16, 1> },
+        { "A/200", decode<0x17, 0> },
+        { "100/128*B-100", decode<0x17, 1> },
+        { "A/200", decode<0x18, 0> },
+        { "100/128*B-100", decode<0x18, 1> },
+        { "A/200", decode<0x19, 0> },
+        { "100/128*B-100", decode<0x19, 1> },
+        { "A/200", decode<0x1a, 0> },
+        { "100/128*B-100", decode<0x1a, 1> },
+        { "A/200", decode<0x1b, 0> },
+        { "100/128*B-100", decode<0x1b, 1> },
+        { "A", decode<0x1c, 0> },
+        { "A", decode<0x1d, 0> },
+        { "A", decode<0x1e, 0> },
+        { "256*A+B", decode<0x1f, 0> },
+        { "256*A+B", decode<0x21, 0> },
+        { "(256*A+B)*0.079", decode<0x22, 0> },
+        { "(256*A+B)*10", decode<0x23, 0> },
+        { "(256*A+B)/32768", decode<0x24, 0> },
+        { "(256*C+D)/8192", decode<0x24, 1> },
+        { "(256*A+B)/32768", decode<0x25, 0> },
+        { "(256*C+D)/8192", decode<0x25, 1> },
+        { "(256*A+B)/32768", decode<0x26, 0> },
+        { "(256*C+D)/8192", decode<0x26, 1> },
+        { "(256*A+B)/32768", decode<0x27, 0> },
+        { "(256*C+D)/8192", decode<0x27, 1> },
+        { "(256*A+B)/32768", decode<0x28, 0> },
+        { "(256*C+D)/8192", decode<0x28, 1> },
+        { "(256*A+B)/32768", decode<0x29, 0> },
+        { "(256*C+D)/8192", decode<0x29, 1> },
+        { "(256*A+B)/32768", decode<0x2a, 0> },
+        { "(256*C+D)/8192", decode<0x2a, 1> },
+        { "(256*A+B)/32768", decode<0x2b, 0> },
+        { "(256*C+D)/8192", decode<0x2b, 1> },
+        { "100/255*A", decode<0x2c, 0> },
+        { "100/128*A-128", decode<0x2d, 0> },
+        { "100/255*A", decode<0x2e, 0> },
+        { "100/255*A", decode<0x2f, 0> },
+        { "A", decode<0x30, 0> },
+        { "256*A+B", decode<0x31, 0> },
+        { "256*A+B-32767", decode<0x32, 0> },
+        { "A", decode<0x33, 0> },
+        { "(256*A+B)/32768", decode<0x34, 0> },
+        { "(256*C+D)/256-128", decode<0x34, 1> },
+        { "(256*A+B)/32768", decode<0x35, 0> },
+        { "(256*C+D)/256-128", decode<0x35, 1> },
+        { "(256*A+B)/32768", decode<0x36, 0> },
+        { "(256*C+D)/256-128", decode<0x36, 1> },
+        { "(256*A+B)/32768", decode<0x37, 0> },
+        { "(256*C+D)/256-128", decode<0x37, 1> },
+        { "(256*A+B)/32768", decode<0x38, 0> },
+        { "(256*C+D)/256-128", decode<0x38, 1> },
+        { "(256*A+B)/32768", decode<0x39, 0> },
+        { "(256*C+D)/256-128", decode<0x39, 1> },
+        { "(256*A+B)/32768", decode<0x3a, 0> },
+        { "(256*C+D)/256-128", decode<0x3a, 1> },
+        { "(256*A+B)/32768", decode<0x3b, 0> },
+        { "(256*C+D)/256-128", decode<0x3b, 1> },
+        { "(256*A+B)/10-40", decode<0x3c, 0> },
+        { "(256*A+B)/10-40", decode<0x3d, 0> },
+        { "(256*A+B)/10-40", decode<0x3e, 0> },
+        { "(256*A+B)/10-40", decode<0x3f, 0> },
+        { "(256*A+B)/1000", decode<0x42, 0> },
+        { "100/255*(256*A+B)", decode<0x43, 0> },
+        { "(256*A+B)/32768", decode<0x44, 0> },
+        { "100/255*A", decode<0x45, 0> },
+        { "A-40", decode<0x46, 0> },
+        { "100/255*A", decode<0x47, 0> },
+        { "100/255*A", decode<0x48, 0> },
+        { "100/255*A", decode<0x49, 0> },
+        { "100/255*A", decode<0x4a, 0> },
+        { "100/255*A", decode<0x4b, 0> },
+        { "100/255*A", decode<0x4c, 0> },
+        { "256*A+B", decode<0x4d, 0> },
+        { "256*A+B", decode<0x4e, 0> },
+        { "A", decode<0x4f, 0> },
+        { "B", decode<0x4f, 1> },
+        { "C", decode<0x4f, 2> },
+        { "D*10", decode<0x4f, 3> },
+        { "A*10", decode<0x50, 0> },
+        { "A", decode<0x51, 0> },
+        { "100/255*A", decode<0x52, 0> },
+        { "(256*A+B)/200", decode<0x53, 0> },
+        { "256*A+B-32767", decode<0x54, 0> },
+        { "100/128*A-100", decode<0x55, 0> },
+        { "100/128*B-100", decode<0x55, 1> },
+        { "100/128*A-100", decode<0x56, 0> },
+        { "100/128*B-100", decode<0x56, 1> },
+        { "100/128*A-100", decode<0x57, 0> },
+        { "100/128*B-100", decode<0x57, 1> },
+        { "100/128*A-100", decode<0x58, 0> },
+        { "100/128*B-100", decode<0x58, 1> },
+        { "(256*A+B)*10", decode<0x59, 0> },
+        { "100/255*A", decode<0x5a, 0> },
+        { "100/255*A", decode<0x5b, 0> },
+        { "A-40", decode<0x5c, 0> },
+        { "(256*A+B)/128-210", decode<0x5d, 0> },
+        { "(256*A+B)/20", decode<0x5e, 0> },
+        { "A", decode<0x5f, 0> },
+        { "A-125", decode<0x61, 0> },
+        { "A-125", decode<0x62, 0> },
+        { "256*A+B", decode<0x63, 0> },
+        { "A-125", decode<0x64, 0> },
+        { "B-125", decode<0x64, 1> },
+        { "C-125", decode<0x64, 2> },
+        { "D-125", decode<0x64, 3> },
+        { "E-125", decode<0x64, 4> },
+    }};
+
+    struct slot {
+        uint16_t first;
+        uint16_t count;
+    };
+
+    // Entries of every PID byte, indexed by the PID
+    inline constexpr std::array<slot, 256> PIDS = {{
+        { 0, 0 },
+        { 0, 0 },
+        { 0, 0 },
+        { 0, 1 },
+        { 1, 1 },
+        { 2, 1 },
+        { 3, 1 },
+        { 4, 1 },
+        { 5, 1 },
+        { 6, 1 },
+        { 7, 1 },
+        { 8, 1 },
+        { 9, 1 },
+        { 10, 1 },
+        { 11, 1 },
+        { 12, 1 },
+        { 13, 1 },
+        { 14, 1 },
+        { 15, 1 },
+        { 16, 1 },
+        { 17, 2 },
+        { 19, 2 },
+        { 21, 2 },
+        { 23, 2 },
+        { 25, 2 },
+        { 27, 2 },
+        { 29, 2 },
+        { 31, 2 },
+        { 33, 1 },
+        { 34, 1 },
+        { 35, 1 },
+        { 36, 1 },
+        { 37, 0 },
+        { 37, 1 },
+        { 38, 1 },
+        { 39, 1 },
+        { 40, 2 },
+        { 42, 2 },
+        { 44, 2 },
+        { 46, 2 },
+        { 48, 2 },
+        { 50, 2 },
+        { 52, 2 },
+        { 54, 2 },
+        { 56, 1 },
+        { 57, 1 },
+        { 58, 1 },
+        { 59, 1 },
+        { 60, 1 },
+        { 61, 1 },
+        { 62, 1 },
+        { 63, 1 },
+        { 64, 2 },
+        { 66, 2 },
+        { 68, 2 },
+        { 70, 2 },
+        { 72, 2 },
+        { 74, 2 },
+        { 76, 2 },
+        { 78, 2 },
+        { 80, 1 },
+        { 81, 1 },
+        { 82, 1 },
+        { 83, 1 },
+        { 84, 0 },
+        { 84, 0 },
+        { 84, 1 },
+        { 85, 1 },
+        { 86, 1 },
+        { 87, 1 },
+        { 88, 1 },
+        { 89, 1 },
+        { 90, 1 },
+        { 91, 1 },
+        { 92, 1 },
+        { 93, 1 },
+        { 94, 1 },
+        { 95, 1 },
+        { 96, 1 },
+        { 97, 4 },
+        { 101, 1 },
+        { 102, 1 },
+        { 103, 1 },
+        { 104, 1 },
+        { 105, 1 },
+        { 106, 2 },
+        { 108, 2 },
+        { 110, 2 },
+        { 112, 2 },
+        { 114, 1 },
+        { 115, 1 },
+        { 116, 1 },
+        { 117, 1 },
+        { 118, 1 },
+        { 119, 1 },
+        { 120, 1 },
+        { 121, 0 },
+        { 121, 1 },
+        { 122, 1 },
+        { 123, 1 },
+        { 124, 5 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+        { 129, 0 },
+    }};
+
+    // Generated decoder of a standard PID with this formula, nullptr if there is none
+    constexpr decode_fn find(uint8_t pid, std::string_view formula) {
+        const slot &s = PIDS[pid];
+
+        for (size_t i = s.first; i < size_t(s.first) + s.count; i++) {
+            if (ENTRIES[i].formula == formula) {
+                return ENTRIES[i].decode;
+            }
+        }
+
+        return nullptr;
+    }
+}
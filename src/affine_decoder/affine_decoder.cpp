@@ -0,0 +1,77 @@
+#include "affine_decoder.h"
+
+#include <limits>
+#include <x86/avx2.h>
+
+namespace obd2_server {
+    affine_decoder::affine_decoder() { }
+
+    size_t affine_decoder::add(const formula &f) {
+        const formula::affine &form = f.get_affine();
+        size_t lane = inputs.size();
+        size_t padded = (lane / VECTOR_WIDTH + 1) * VECTOR_WIDTH;
+
+        // A single byte reads as a word with itself as the low byte and no high byte
+        inputs.push_back({
+            form.first,
+            form.word ? form.second : form.first,
+            uint16_t(form.word ? 256 : 0),
+            uint8_t(f.get_required_bytes())
+        });
+
+        if (bias.size() < padded) {
+            bias.resize(padded, -0.0f);
+            scale.resize(padded, 1);
+            divisor.resize(padded, 1);
+            post_scale.resize(padded, 1);
+            offset.resize(padded, -0.0f);
+            x.resize(padded, 0);
+            values.resize(padded);
+        }
+
+        bias[lane] = form.bias;
+        scale[lane] = form.scale;
+        divisor[lane] = form.divisor;
+        post_scale[lane] = form.post_scale;
+        offset[lane] = form.offset;
+
+        return lane;
+    }
+
+    const float *affine_decoder::evaluate(const std::vector<uint8_t> *const *payloads) {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+
+        // NaN passes every step unchanged, like the interpreter's result for short responses
+        for (size_t lane = 0; lane < inputs.size(); lane++) {
+            const input &in = inputs[lane];
+            const std::vector<uint8_t> *payload = payloads[lane];
+
+            if (payload == nullptr || payload->size() < in.required_bytes) {
+                x[lane] = nan;
+            }
+            else {
+                const uint8_t *data = payload->data();
+                x[lane] = float(data[in.high] * in.high_weight + data[in.low]);
+            }
+        }
+
+        // Same operations in the same order as the formula program, so the results are bit identical
+        for (size_t i = 0; i < x.size(); i += VECTOR_WIDTH) {
+            simde__m256 v = simde_mm256_loadu_ps(&x[i]);
+
+            v = simde_mm256_add_ps(v, simde_mm256_loadu_ps(&bias[i]));
+            v = simde_mm256_mul_ps(v, simde_mm256_loadu_ps(&scale[i]));
+            v = simde_mm256_div_ps(v, simde_mm256_loadu_ps(&divisor[i]));
+            v = simde_mm256_mul_ps(v, simde_mm256_loadu_ps(&post_scale[i]));
+            v = simde_mm256_add_ps(v, simde_mm256_loadu_ps(&offset[i]));
+
+            simde_mm256_storeu_ps(&values[i], v);
+        }
+
+        return values.data();
+    }
+
+    size_t affine_decoder::size() const {
+        return inputs.size();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../formula/formula.h"
+
+namespace obd2_server {
+    // Decodes the channels with affine formulas of a snapshot together, one SIMD lane per channel.
+    // The inputs of all lanes are gathered in one loop, then all lanes run through the steps of
+    // formula::affine at once, so the cost per channel is a byte load and a fraction of a vector operation.
+    class affine_decoder {
+        private:
+            static constexpr size_t VECTOR_WIDTH = 8;
+
+            struct input {
+                uint8_t high;
+                uint8_t low;
+                uint16_t high_weight;
+                uint8_t required_bytes;
+            };
+
+            std::vector<input> inputs;
+            // Steps of every lane, padded with identities to whole vectors
+            std::vector<float> bias;
+            std::vector<float> scale;
+            std::vector<float> divisor;
+            std::vector<float> post_scale;
+            std::vector<float> offset;
+            std::vector<float> x;
+            std::vector<float> values;
+
+        public:
+            affine_decoder();
+
+            // Adds a lane for a formula with is_affine() and returns its index
+            size_t add(const formula &f);
+            // Decodes all lanes from the payload of every lane, payloads[i] belongs to lane i. A null payload
+            // or one too short for the formula decodes to NaN. The result is valid until the next call.
+            const float *evaluate(const std::vector<uint8_t> *const *payloads);
+
+            size_t size() const;
+    };
+}
@@ -0,0 +1,43 @@
+#include "bus_merger.h"
+
+namespace obd2_server {
+    bus_merger::bus_merger() { }
+
+    bus_merger::bus_merger(size_t bus_count, uint64_t max_lateness_ms) 
+        : queues(bus_count), max_lateness_ms(max_lateness_ms) { }
+
+    void bus_merger::push(size_t bus, uint64_t timestamp, std::vector<float> &&values) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queues[bus].push_back({ timestamp, bus, std::move(values) });
+    }
+
+    bool bus_merger::pop(sample &out, uint64_t now_ms) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::deque<sample> *oldest = nullptr;
+        bool all_buses_ready = true;
+
+        for (std::deque<sample> &queue : queues) {
+            if (queue.empty()) {
+                all_buses_ready = false;
+                continue;
+            }
+
+            if (oldest == nullptr || queue.front().timestamp < oldest->front().timestamp) {
+                oldest = &queue;
+            }
+        }
+
+        if (oldest == nullptr) {
+            return false;
+        }
+
+        // An empty bus may still deliver an older sample until the lateness bound has passed
+        if (!all_buses_ready && oldest->front().timestamp + max_lateness_ms > now_ms) {
+            return false;
+        }
+
+        out = std::move(oldest->front());
+        oldest->pop_front();
+        return true;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace obd2_server {
+    // Merges the samples of several buses into one stream ordered by timestamp
+    class bus_merger {
+        public:
+            struct sample {
+                uint64_t timestamp;
+                size_t bus;
+                std::vector<float> values;
+            };
+
+        private:
+            std::mutex mutex;
+            std::vector<std::deque<sample>> queues;
+            uint64_t max_lateness_ms = 0;
+
+        public:
+            bus_merger();
+            // A bus silent for max_lateness_ms no longer holds back the other buses
+            bus_merger(size_t bus_count, uint64_t max_lateness_ms);
+
+            // Samples of a single bus must be pushed in timestamp order
+            void push(size_t bus, uint64_t timestamp, std::vector<float> &&values);
+
+            // Takes the oldest sample no later push can precede, false if there is none yet
+            bool pop(sample &out, uint64_t now_ms);
+    };
+}
@@ -0,0 +1,148 @@
+#include "channel_graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace obd2_server {
+    channel_graph::channel_graph() { }
+
+    channel_graph::channel_graph(const vehicle &v, const std::vector<const request *> &inputs) : input_count(inputs.size()) {
+        for (const virtual_channel &c : v.get_virtual_channels()) {
+            channels.push_back(&c);
+        }
+
+        const size_t missing_slot = input_count + channels.size();
+        uuid_table input_ids;
+        uuid_table channel_ids;
+        uuid_table known_ids;
+
+        for (const request *r : inputs) {
+            input_ids.push_back(r->id);
+        }
+
+        for (const virtual_channel *c : channels) {
+            channel_ids.push_back(c->id);
+        }
+
+        for (const request &r : v.get_requests()) {
+            known_ids.push_back(r.id);
+        }
+
+        std::vector<formula> expressions;
+        std::vector<std::vector<size_t>> sources(channels.size());
+
+        // Resolve references by name or id, requests first
+        for (size_t i = 0; i < channels.size(); i++) {
+            try {
+                expressions.emplace_back(channels[i]->formula);
+            }
+            catch (std::invalid_argument &e) {
+                throw std::invalid_argument("Virtual channel " + channels[i]->name + ": " + e.what());
+            }
+
+            if (expressions.back().get_required_bytes() != 0) {
+                throw std::invalid_argument("Virtual channel " + channels[i]->name + " refers to payload bytes");
+            }
+
+            for (const std::string &reference : expressions.back().get_variables()) {
+                auto matches = [&reference](const auto *c) noexcept {
+                    return c->name == reference;
+                };
+                size_t input = input_ids.find_string(reference);
+                size_t channel = channel_ids.find_string(reference);
+
+                if (input == uuid_table::NPOS) {
+                    input = std::find_if(inputs.begin(), inputs.end(), matches) - inputs.begin();
+                }
+
+                if (channel == uuid_table::NPOS) {
+                    channel = std::find_if(channels.begin(), channels.end(), matches) - channels.begin();
+                }
+
+                if (input < inputs.size()) {
+                    sources[i].push_back(input);
+                }
+                else if (channel < channels.size()) {
+                    sources[i].push_back(input_count + channel);
+                }
+                else if (known_ids.find_string(reference) != uuid_table::NPOS 
+                    || std::any_of(v.get_requests().begin(), v.get_requests().end(), [&matches](const request &r) noexcept { return matches(&r); })) {
+                    sources[i].push_back(missing_slot);
+                }
+                else {
+                    throw std::invalid_argument("Virtual channel " + channels[i]->name + " refers to unknown channel " + reference);
+                }
+            }
+        }
+
+        // Kahn's algorithm over the references between virtual channels
+        std::vector<size_t> pending(channels.size(), 0);
+        std::vector<std::vector<size_t>> dependents(channels.size());
+        std::vector<size_t> ready;
+
+        for (size_t i = 0; i < channels.size(); i++) {
+            for (size_t source : sources[i]) {
+                if (source >= input_count && source != missing_slot) {
+                    pending[i]++;
+                    dependents[source - input_count].push_back(i);
+                }
+            }
+
+            if (pending[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+
+        while (!ready.empty()) {
+            size_t i = ready.back();
+            ready.pop_back();
+
+            node &n = nodes.emplace_back();
+            n.slot = input_count + i;
+            n.expression = expressions[i];
+            n.sources = sources[i];
+            n.state.assign(expressions[i].get_state_size(), 0);
+
+            for (size_t dependent : dependents[i]) {
+                if (--pending[dependent] == 0) {
+                    ready.push_back(dependent);
+                }
+            }
+        }
+
+        if (nodes.size() != channels.size()) {
+            for (size_t i = 0; i < channels.size(); i++) {
+                if (pending[i] != 0) {
+                    throw std::invalid_argument("Virtual channel " + channels[i]->name + " depends on itself");
+                }
+            }
+        }
+
+        values.assign(missing_slot + 1, std::numeric_limits<float>::quiet_NaN());
+    }
+
+    void channel_graph::evaluate(uint64_t timestamp, const float *inputs, float *outputs) {
+        std::copy(inputs, inputs + input_count, values.begin());
+
+        for (node &n : nodes) {
+            arguments.resize(n.sources.size());
+
+            for (size_t i = 0; i < n.sources.size(); i++) {
+                arguments[i] = values[n.sources[i]];
+            }
+
+            values[n.slot] = n.expression.evaluate(arguments.data(), timestamp, n.state.data());
+        }
+
+        std::copy(values.begin() + input_count, values.begin() + input_count + channels.size(), outputs);
+    }
+
+    const std::vector<const virtual_channel *> &channel_graph::get_channels() const {
+        return channels;
+    }
+
+    bool channel_graph::empty() const {
+        return channels.empty();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../formula/formula.h"
+#include "../vehicle/vehicle.h"
+
+namespace obd2_server {
+    // Computes the virtual channels of a vehicle from one snapshot of request values,
+    // every channel after the channels it refers to
+    class channel_graph {
+        private:
+            struct node {
+                size_t slot;
+                formula expression;
+                std::vector<size_t> sources;
+                std::vector<double> state;
+            };
+
+            size_t input_count = 0;
+            std::vector<const virtual_channel *> channels;
+            // Evaluation order
+            std::vector<node> nodes;
+            // Inputs, then virtual channels in definition order, then a slot that stays NaN
+            std::vector<float> values;
+            std::vector<float> arguments;
+
+        public:
+            channel_graph();
+            // inputs are the requests whose values are passed to evaluate, in that order. References to 
+            // requests of the vehicle that are not among them evaluate as missing values.
+            channel_graph(const vehicle &v, const std::vector<const request *> &inputs);
+
+            // Timestamps in ms, outputs receive one value per channel in definition order
+            void evaluate(uint64_t timestamp, const float *inputs, float *outputs);
+
+            const std::vector<const virtual_channel *> &get_channels() const;
+            bool empty() const;
+    };
+}
@@ -0,0 +1,347 @@
+#include "csv_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+
+namespace obd2_server {
+    static_assert(std::endian::native == std::endian::little, "Indexes are stored in host byte order");
+
+    namespace {
+        const uint32_t SECONDS_PER_DAY = 86400;
+
+        struct column_summary {
+            float min;
+            float max;
+            uint32_t missing;
+        };
+
+        template <typename T>
+        void write_value(std::ofstream &file, T value) {
+            file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        T read_value(std::ifstream &file) {
+            T value{};
+            file.read(reinterpret_cast<char *>(&value), sizeof(value));
+            return value;
+        }
+
+        std::vector<std::string> parse_header(const std::string &line) {
+            std::vector<std::string> names;
+            size_t start = 0;
+
+            while (start <= line.size()) {
+                size_t end = std::min(line.find(',', start), line.size());
+                std::string name = line.substr(start, end - start);
+
+                if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+                    name = name.substr(1, name.size() - 2);
+                }
+
+                names.push_back(name);
+                start = end + 1;
+            }
+
+            return names;
+        }
+
+        int64_t get_mtime(const std::string &filename) {
+            return std::filesystem::last_write_time(filename).time_since_epoch().count();
+        }
+
+        // Rows are in time order, so a clock far behind the last row went past midnight
+        void advance_clock(uint32_t time_of_day, uint32_t &last_time_of_day, uint32_t &day) {
+            if (time_of_day + SECONDS_PER_DAY / 2 < last_time_of_day) {
+                day++;
+            }
+
+            last_time_of_day = time_of_day;
+        }
+    }
+
+    csv_index::csv_index() { }
+
+    csv_index::csv_index(const std::string &log_filename) : log_file(log_filename, std::ios::binary) {
+        std::string index_filename = log_filename + ".idx";
+        std::string line;
+
+        if (!log_file.is_open()) {
+            throw std::runtime_error("Cannot open file " + log_filename);
+        }
+
+        if (!std::getline(log_file, line)) {
+            throw std::runtime_error(log_filename + " is empty");
+        }
+
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        columns = parse_header(line);
+        columns.erase(columns.begin());
+
+        if (!is_current(log_filename, index_filename)) {
+            build(log_filename, index_filename);
+        }
+
+        index_file.open(index_filename, std::ios::binary);
+
+        if (!index_file.is_open()) {
+            throw std::runtime_error("Cannot open file " + index_filename);
+        }
+
+        index_file.seekg(HEADER_SIZE - sizeof(block_count));
+        block_count = read_value<uint64_t>(index_file);
+    }
+
+    bool csv_index::is_current(const std::string &log_filename, const std::string &index_filename) const {
+        std::ifstream file(index_filename, std::ios::binary);
+        char magic[sizeof(CSV_INDEX_MAGIC)];
+
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, CSV_INDEX_MAGIC, sizeof(magic)) != 0) {
+            return false;
+        }
+
+        uint64_t log_size = read_value<uint64_t>(file);
+        int64_t log_mtime = read_value<int64_t>(file);
+        uint32_t column_count = read_value<uint32_t>(file);
+
+        // A log still being written outgrows its index
+        return file && log_size == std::filesystem::file_size(log_filename) 
+            && log_mtime == get_mtime(log_filename) && column_count == columns.size();
+    }
+
+    void csv_index::build(const std::string &log_filename, const std::string &index_filename) {
+        std::ifstream log(log_filename, std::ios::binary);
+        std::string temp_filename = index_filename + ".tmp";
+        std::ofstream file(temp_filename, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file " + temp_filename);
+        }
+
+        uint64_t log_size = std::filesystem::file_size(log_filename);
+        int64_t log_mtime = get_mtime(log_filename);
+        const float inf = std::numeric_limits<float>::infinity();
+
+        file.write(CSV_INDEX_MAGIC, sizeof(CSV_INDEX_MAGIC));
+        write_value<uint64_t>(file, log_size);
+        write_value<int64_t>(file, log_mtime);
+        write_value<uint32_t>(file, columns.size());
+        write_value<uint32_t>(file, 0);
+        write_value<uint64_t>(file, 0);
+
+        std::string line;
+        std::getline(log, line);
+
+        uint64_t offset = line.size() + 1;
+        uint64_t count = 0;
+        std::vector<column_summary> summaries(columns.size());
+        std::vector<float> values(columns.size());
+        block current{};
+        uint32_t row_day = 0;
+        uint32_t last_time_of_day = 0;
+        uint32_t time_of_day = 0;
+        bool first_row = true;
+
+        auto flush_block = [&]() {
+            write_value<uint64_t>(file, current.offset);
+            write_value<uint32_t>(file, current.rows);
+            write_value<uint32_t>(file, current.first_time);
+            write_value<uint32_t>(file, current.last_time);
+            write_value<uint32_t>(file, 0);
+
+            for (const column_summary &s : summaries) {
+                write_value<float>(file, s.min);
+                write_value<float>(file, s.max);
+                write_value<uint32_t>(file, s.missing);
+            }
+
+            count++;
+        };
+
+        while (std::getline(log, line)) {
+            uint64_t line_offset = offset;
+            offset += line.size() + 1;
+
+            parse_row(line, time_of_day, values);
+
+            if (first_row) {
+                last_time_of_day = time_of_day;
+                first_row = false;
+            }
+
+            advance_clock(time_of_day, last_time_of_day, row_day);
+            uint32_t time = row_day * SECONDS_PER_DAY + time_of_day;
+
+            if (current.rows == 0) {
+                current.offset = line_offset;
+                current.first_time = time;
+                std::fill(summaries.begin(), summaries.end(), column_summary{ inf, -inf, 0 });
+            }
+
+            for (size_t i = 0; i < summaries.size(); i++) {
+                if (std::isnan(values[i])) {
+                    summaries[i].missing++;
+                }
+                else {
+                    summaries[i].min = std::min(summaries[i].min, values[i]);
+                    summaries[i].max = std::max(summaries[i].max, values[i]);
+                }
+            }
+
+            current.last_time = time;
+
+            if (++current.rows == BLOCK_ROWS) {
+                flush_block();
+                current.rows = 0;
+            }
+        }
+
+        if (current.rows != 0) {
+            flush_block();
+        }
+
+        file.seekp(HEADER_SIZE - sizeof(count));
+        write_value<uint64_t>(file, count);
+        file.close();
+
+        if (!file) {
+            throw std::runtime_error("Cannot write file " + temp_filename);
+        }
+
+        // Readers never see a half written index
+        std::filesystem::rename(temp_filename, index_filename);
+    }
+
+    size_t csv_index::block_size() const {
+        return BLOCK_HEADER_SIZE + columns.size() * COLUMN_SIZE;
+    }
+
+    const std::vector<std::string> &csv_index::get_columns() const {
+        return columns;
+    }
+
+    size_t csv_index::get_block_count() const {
+        return block_count;
+    }
+
+    void csv_index::read_block(size_t i, block &out) {
+        if (i >= block_count) {
+            throw std::out_of_range("Block " + std::to_string(i) + " is out of range");
+        }
+
+        index_file.seekg(HEADER_SIZE + i * block_size());
+
+        out.offset = read_value<uint64_t>(index_file);
+        out.rows = read_value<uint32_t>(index_file);
+        out.first_time = read_value<uint32_t>(index_file);
+        out.last_time = read_value<uint32_t>(index_file);
+        read_value<uint32_t>(index_file);
+        out.ranges.resize(columns.size());
+
+        for (formula::range &r : out.ranges) {
+            r.min = read_value<float>(index_file);
+            r.max = read_value<float>(index_file);
+            r.maybe_nan = read_value<uint32_t>(index_file) != 0;
+        }
+
+        if (!index_file) {
+            throw std::runtime_error("Truncated index");
+        }
+    }
+
+    size_t csv_index::find_block(uint32_t time) {
+        size_t low = 0;
+        size_t high = block_count;
+
+        // Binary search on the last time of each block, reading only that field
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+
+            index_file.seekg(HEADER_SIZE + mid * block_size() + 16);
+
+            if (read_value<uint32_t>(index_file) < time) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+
+        return low;
+    }
+
+    void csv_index::seek(const block &b) {
+        log_file.clear();
+        log_file.seekg(b.offset);
+        remaining_rows = b.rows;
+        day = b.first_time / SECONDS_PER_DAY;
+        last_time_of_day = b.first_time % SECONDS_PER_DAY;
+    }
+
+    bool csv_index::next_row(std::string &line, uint32_t &time, std::vector<float> &values) {
+        if (remaining_rows == 0 || !std::getline(log_file, line)) {
+            return false;
+        }
+
+        uint32_t time_of_day = last_time_of_day;
+
+        values.resize(columns.size());
+        remaining_rows--;
+        parse_row(line, time_of_day, values);
+        advance_clock(time_of_day, last_time_of_day, day);
+        time = day * SECONDS_PER_DAY + time_of_day;
+
+        return true;
+    }
+
+    bool csv_index::parse_time(const char *begin, const char *end, uint32_t &time_of_day) {
+        uint32_t parts[3];
+
+        for (size_t i = 0; i < 3; i++) {
+            std::from_chars_result res = std::from_chars(begin, end, parts[i]);
+
+            if (res.ec != std::errc() || (i < 2 && (res.ptr == end || *res.ptr != ':'))) {
+                return false;
+            }
+
+            begin = res.ptr + 1;
+        }
+
+        if (parts[0] > 23 || parts[1] > 59 || parts[2] > 60) {
+            return false;
+        }
+
+        time_of_day = parts[0] * 3600 + parts[1] * 60 + parts[2];
+        return true;
+    }
+
+    void csv_index::parse_row(const std::string &line, uint32_t &time_of_day, std::vector<float> &values) {
+        const char *pos = line.data();
+        const char *end = line.data() + line.size();
+        const char *field_end = std::find(pos, end, ',');
+
+        // A malformed time keeps the previous one
+        parse_time(pos, field_end, time_of_day);
+
+        for (float &value : values) {
+            value = std::numeric_limits<float>::quiet_NaN();
+        }
+
+        for (size_t i = 0; i < values.size() && field_end != end; i++) {
+            pos = field_end + 1;
+            field_end = std::find(pos, end, ',');
+
+            // from_chars also reads the "nan" written for missing responses
+            std::from_chars(pos, field_end, values[i]);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../formula/formula.h"
+
+namespace obd2_server {
+    // Sparse index stored next to a csv log as <log>.idx, all integers little endian.
+    //   header: "OBD2IDX1", uint64 log size, int64 log mtime, uint32 column count, uint32 reserved, uint64 block count
+    //   block:  uint64 row offset, uint32 rows, uint32 first time, uint32 last time, uint32 reserved,
+    //           per data column float min, float max, uint32 missing values
+    // Times are seconds since midnight of the log's first day, so they keep rising past midnight.
+    static constexpr char CSV_INDEX_MAGIC[8] = { 'O', 'B', 'D', '2', 'I', 'D', 'X', '1' };
+
+    class csv_index {
+        public:
+            static constexpr size_t BLOCK_ROWS = 1024;
+
+            struct block {
+                uint64_t offset;
+                uint32_t rows;
+                uint32_t first_time;
+                uint32_t last_time;
+
+                // Bounds per data column, min > max if the block holds no value of the column
+                std::vector<formula::range> ranges;
+            };
+
+        private:
+            static constexpr size_t HEADER_SIZE = 40;
+            static constexpr size_t BLOCK_HEADER_SIZE = 24;
+            static constexpr size_t COLUMN_SIZE = 12;
+
+            std::ifstream index_file;
+            std::ifstream log_file;
+            std::vector<std::string> columns;
+            uint64_t block_count = 0;
+
+            // Row cursor within the current block
+            uint32_t remaining_rows = 0;
+            uint32_t day = 0;
+            uint32_t last_time_of_day = 0;
+
+            bool is_current(const std::string &log_filename, const std::string &index_filename) const;
+            void build(const std::string &log_filename, const std::string &index_filename);
+            size_t block_size() const;
+
+        public:
+            csv_index();
+            // Opens the index of a log, building it first if it is missing or older than the log
+            csv_index(const std::string &log_filename);
+
+            // Data column names, without the timestamp
+            const std::vector<std::string> &get_columns() const;
+            size_t get_block_count() const;
+
+            void read_block(size_t i, block &out);
+            // First block that may hold rows at or after time
+            size_t find_block(uint32_t time);
+
+            // Positions the row cursor at the first row of a block
+            void seek(const block &b);
+            // Reads the next row of the block, false after its last row
+            bool next_row(std::string &line, uint32_t &time, std::vector<float> &values);
+
+            // Parses "HH:MM:SS" into seconds since midnight
+            static bool parse_time(const char *begin, const char *end, uint32_t &time_of_day);
+            static void parse_row(const std::string &line, uint32_t &time_of_day, std::vector<float> &values);
+    };
+}
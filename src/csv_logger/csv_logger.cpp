@@ -1,7 +1,10 @@
 #include "csv_logger.h"
 
+#include <charconv>
 #include <chrono>
+#include <ctime>
 #include <fstream>
+#include "../trace/tracer.h"
 
 namespace obd2_server {
     csv_logger::csv_logger() {}
@@ -17,18 +20,91 @@ namespace obd2_server {
         }
         
         write_header(header);
+        row_buffer.resize(MAX_TIME_CHARS + header.size() * MAX_FIELD_CHARS + 1);
+    }
+
+    void csv_logger::set_precisions(const std::vector<int> &precisions) {
+        this->precisions = precisions;
+    }
+
+    void csv_logger::set_autoflush(bool autoflush) {
+        this->autoflush = autoflush;
     }
 
     void csv_logger::write_row(const std::vector<float> &data) {
         uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        write_row(timestamp, data);
+    }
 
-        file << get_time_string(timestamp);
+    void csv_logger::write_row(uint64_t timestamp, const std::vector<float> &data) {
+        trace_scope trace("csv write");
+        size_t required = MAX_TIME_CHARS + data.size() * MAX_FIELD_CHARS + 1;
 
-        for (float d : data) {
-            file  << "," << d;
+        if (row_buffer.size() < required) {
+            row_buffer.resize(required);
         }
 
-        file << std::endl;
+        char *out = row_buffer.data();
+
+        out += write_time_string(out, timestamp);
+
+        for (size_t i = 0; i < data.size(); i++) {
+            int precision = i < precisions.size() ? precisions[i] : -1;
+
+            *out++ = ',';
+
+            // to_chars is locale independent and never allocates
+            char *field_end = out + MAX_FIELD_CHARS - 1;
+            std::to_chars_result res = precision < 0
+                ? std::to_chars(out, field_end, data[i])
+                : std::to_chars(out, field_end, data[i], std::chars_format::fixed, precision);
+            
+            // Values too large for fixed notation fall back to the shortest form
+            if (res.ec != std::errc()) {
+                res = std::to_chars(out, field_end, data[i]);
+            }
+
+            out = res.ptr;
+        }
+
+        *out++ = '\n';
+
+        file.write(row_buffer.data(), out - row_buffer.data());
+
+        if (autoflush) {
+            file.flush();
+        }
+    }
+
+    void csv_logger::write_marker(uint64_t timestamp, const std::string &text) {
+        char time[MAX_TIME_CHARS];
+        size_t length = write_time_string(time, timestamp);
+
+        file.write(time, length);
+        file << ",\"";
+
+        // Quotes are doubled as RFC 4180 requires. Line breaks become spaces so the marker stays one row.
+        for (char c : text) {
+            if (c == '"') {
+                file << "\"\"";
+            }
+            else if (c == '\n' || c == '\r') {
+                file << ' ';
+            }
+            else {
+                file << c;
+            }
+        }
+
+        file << "\"\n";
+
+        if (autoflush) {
+            file.flush();
+        }
+    }
+
+    void csv_logger::write_schema(const std::vector<std::string> &header) {
+        write_header(header);
     }
 
     void csv_logger::write_header(const std::vector<std::string> &header) {
@@ -45,13 +121,10 @@ namespace obd2_server {
         file << std::endl;
     }
     
-    std::string csv_logger::get_time_string(uint64_t timestamp) const {
+    size_t csv_logger::write_time_string(char *out, uint64_t timestamp) const {
         std::time_t time = timestamp / 1000;
         std::tm *tm = std::localtime(&time);
 
-        char buffer[80];
-        std::strftime(buffer, 80, "%H:%M:%S", tm);
-
-        return std::string(buffer);
+        return std::strftime(out, MAX_TIME_CHARS, "%H:%M:%S", tm);
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <fstream>
@@ -7,16 +8,33 @@
 namespace obd2_server {
     class csv_logger {
         private:
+            // Upper bound for a single formatted value including the separator
+            static constexpr size_t MAX_FIELD_CHARS = 32;
+            static constexpr size_t MAX_TIME_CHARS = 16;
+
             std::ofstream file;
+            std::vector<char> row_buffer;
+            std::vector<int> precisions;
+            bool autoflush = true;
 
             void write_header(const std::vector<std::string> &header);
-            std::string get_time_string(uint64_t timestamp) const;
+            size_t write_time_string(char *out, uint64_t timestamp) const;
             
         public:
             csv_logger();
             csv_logger(const std::vector<std::string> &header);
             csv_logger(const std::vector<std::string> &header, const std::string &filename);
 
+            // Fixed decimals per data column, -1 keeps the shortest round-trip representation
+            void set_precisions(const std::vector<int> &precisions);
+            // Flushing every row keeps live logs intact on a crash, bulk writers may turn it off
+            void set_autoflush(bool autoflush);
             void write_row(const std::vector<float> &data);
+            void write_row(uint64_t timestamp, const std::vector<float> &data);
+            // Writes text instead of the values of a row, e.g. to mark an event. Quotes are escaped and
+            // line breaks replaced by spaces.
+            void write_marker(uint64_t timestamp, const std::string &text);
+            // Starts a new section with its own header row, for when the logged channels change
+            void write_schema(const std::vector<std::string> &header);
     };
 }
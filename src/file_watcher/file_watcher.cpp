@@ -0,0 +1,72 @@
+#include "file_watcher.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace obd2_server {
+    file_watcher::file_watcher(const std::string &path) {
+        std::filesystem::path file(path);
+        std::filesystem::path directory = file.has_parent_path() ? file.parent_path() : std::filesystem::path(".");
+
+        filename = file.filename();
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (fd < 0) {
+            throw std::runtime_error(std::string("Cannot create inotify instance: ") + std::strerror(errno));
+        }
+
+        if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("Cannot watch " + directory.string() + ": " + std::strerror(error));
+        }
+    }
+
+    file_watcher::~file_watcher() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    bool file_watcher::wait(int timeout_ms) {
+        if (!read_events(timeout_ms)) {
+            return false;
+        }
+
+        // Let a burst of writes finish before the file is read
+        while (read_events(SETTLE_MS)) { }
+
+        return true;
+    }
+
+    bool file_watcher::read_events(int timeout_ms) {
+        pollfd p = { fd, POLLIN, 0 };
+
+        if (poll(&p, 1, timeout_ms) <= 0) {
+            return false;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        bool changed = false;
+        ssize_t length;
+
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char *pos = buffer; pos < buffer + length; ) {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(pos);
+
+                if (event->len != 0 && filename == event->name) {
+                    changed = true;
+                }
+
+                pos += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        return changed;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+namespace obd2_server {
+    // Reports changes of a single file through inotify. The directory is watched instead of
+    // the file, so editors that replace the file by renaming a new one over it are seen too.
+    class file_watcher {
+        private:
+            // Changes arriving this soon after one another are reported once
+            static constexpr int SETTLE_MS = 200;
+
+            int fd = -1;
+            std::string filename;
+
+            bool read_events(int timeout_ms);
+
+        public:
+            file_watcher(const std::string &path);
+            file_watcher(const file_watcher &) = delete;
+            ~file_watcher();
+
+            file_watcher &operator=(const file_watcher &) = delete;
+
+            // Waits up to timeout_ms for the file to change, true if it did
+            bool wait(int timeout_ms);
+    };
+}
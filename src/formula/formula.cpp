@@ -0,0 +1,985 @@
+#include "formula.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <x86/avx2.h>
+
+namespace obd2_server {
+    // Samples per column block, a multiple of the vector width
+    static constexpr size_t BLOCK_SIZE = 256;
+    static constexpr size_t VECTOR_WIDTH = 8;
+
+    namespace {
+        // Recursive descent parser emitting postfix instructions
+        class parser {
+            private:
+                const std::string &expression;
+                std::vector<formula::instruction> &program;
+                std::vector<std::string> &variables;
+                size_t &state_calls;
+                size_t pos = 0;
+
+                void skip_whitespace() {
+                    while (pos < expression.size() && std::isspace(static_cast<unsigned char>(expression[pos]))) {
+                        pos++;
+                    }
+                }
+
+                bool accept(char c) {
+                    skip_whitespace();
+
+                    if (pos < expression.size() && expression[pos] == c) {
+                        pos++;
+                        return true;
+                    }
+
+                    return false;
+                }
+
+                bool accept(const char *token) {
+                    size_t length = std::strlen(token);
+
+                    skip_whitespace();
+
+                    if (expression.compare(pos, length, token) == 0) {
+                        pos += length;
+                        return true;
+                    }
+
+                    return false;
+                }
+
+                void error(const std::string &what) const {
+                    throw std::invalid_argument("Invalid formula \"" + expression + "\": " + what + " at position " + std::to_string(pos));
+                }
+
+                void emit(formula::opcode op, uint8_t index = 0, float value = 0) {
+                    program.push_back({ op, index, value });
+                }
+
+                void parse_or() {
+                    parse_and();
+
+                    while (accept("||")) {
+                        parse_and();
+                        emit(formula::opcode::logical_or);
+                    }
+                }
+
+                void parse_and() {
+                    parse_comparison();
+
+                    while (accept("&&")) {
+                        parse_comparison();
+                        emit(formula::opcode::logical_and);
+                    }
+                }
+
+                void parse_comparison() {
+                    parse_expression();
+
+                    // Two character operators first, '<' would also match "<="
+                    static constexpr std::pair<const char *, formula::opcode> OPERATORS[] = {
+                        { "<=", formula::opcode::le },
+                        { ">=", formula::opcode::ge },
+                        { "==", formula::opcode::eq },
+                        { "!=", formula::opcode::ne },
+                        { "<", formula::opcode::lt },
+                        { ">", formula::opcode::gt }
+                    };
+
+                    while (true) {
+                        bool matched = false;
+
+                        for (const auto &[token, op] : OPERATORS) {
+                            if (accept(token)) {
+                                parse_expression();
+                                emit(op);
+                                matched = true;
+                                break;
+                            }
+                        }
+
+                        if (!matched) {
+                            return;
+                        }
+                    }
+                }
+
+                void parse_expression() {
+                    parse_term();
+
+                    while (true) {
+                        if (accept('+')) {
+                            parse_term();
+                            emit(formula::opcode::add);
+                        }
+                        else if (accept('-')) {
+                            parse_term();
+                            emit(formula::opcode::sub);
+                        }
+                        else {
+                            return;
+                        }
+                    }
+                }
+
+                void parse_term() {
+                    parse_unary();
+
+                    while (true) {
+                        if (accept('*')) {
+                            parse_unary();
+                            emit(formula::opcode::mul);
+                        }
+                        else if (accept('/')) {
+                            parse_unary();
+                            emit(formula::opcode::div);
+                        }
+                        else {
+                            return;
+                        }
+                    }
+                }
+
+                void parse_unary() {
+                    if (accept('!')) {
+                        parse_unary();
+                        emit(formula::opcode::logical_not);
+                        return;
+                    }
+
+                    if (accept('-')) {
+                        parse_unary();
+                        emit(formula::opcode::neg);
+                        return;
+                    }
+
+                    accept('+');
+                    parse_primary();
+                }
+
+                void parse_primary() {
+                    skip_whitespace();
+
+                    if (pos >= expression.size()) {
+                        error("unexpected end");
+                    }
+
+                    char c = expression[pos];
+
+                    if (c == '(') {
+                        pos++;
+                        parse_or();
+
+                        if (!accept(')')) {
+                            error("expected ')'");
+                        }
+
+                        return;
+                    }
+
+                    if (c == '[') {
+                        size_t end = expression.find(']', pos);
+
+                        if (end == std::string::npos) {
+                            error("expected ']'");
+                        }
+
+                        std::string name = expression.substr(pos + 1, end - pos - 1);
+                        auto it = std::find(variables.begin(), variables.end(), name);
+
+                        if (it == variables.end()) {
+                            if (variables.size() == formula::MAX_VARIABLES) {
+                                error("too many channels");
+                            }
+
+                            it = variables.insert(variables.end(), name);
+                        }
+
+                        pos = end + 1;
+                        emit(formula::opcode::push_var, it - variables.begin());
+                        return;
+                    }
+
+                    if (c >= 'a' && c <= 'z') {
+                        parse_call();
+                        return;
+                    }
+
+                    if (c >= 'A' && c <= 'Z') {
+                        pos++;
+                        emit(formula::opcode::push_byte, c - 'A');
+                        return;
+                    }
+
+                    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                        // from_chars does not depend on the locale's decimal point
+                        const char *start = expression.c_str() + pos;
+                        float value;
+                        std::from_chars_result res = std::from_chars(start, expression.c_str() + expression.size(), value);
+
+                        if (res.ec != std::errc()) {
+                            error("invalid number");
+                        }
+
+                        pos += res.ptr - start;
+                        emit(formula::opcode::push_const, 0, value);
+                        return;
+                    }
+
+                    error(std::string("unexpected '") + c + "'");
+                }
+
+                void parse_call() {
+                    static constexpr std::pair<std::string_view, formula::opcode> FUNCTIONS[] = {
+                        { "integrate", formula::opcode::integrate },
+                        { "prev", formula::opcode::prev },
+                        { "rate", formula::opcode::rate }
+                    };
+
+                    size_t start = pos;
+
+                    while (pos < expression.size() && ((expression[pos] >= 'a' && expression[pos] <= 'z') || expression[pos] == '_')) {
+                        pos++;
+                    }
+
+                    std::string_view name(expression.data() + start, pos - start);
+                    auto it = std::find_if(std::begin(FUNCTIONS), std::end(FUNCTIONS), [&name](const auto &f) noexcept { return f.first == name; });
+
+                    if (it == std::end(FUNCTIONS)) {
+                        pos = start;
+                        error("unknown function");
+                    }
+
+                    if (!accept('(')) {
+                        error("expected '('");
+                    }
+
+                    parse_or();
+
+                    if (!accept(')')) {
+                        error("expected ')'");
+                    }
+
+                    // Every call site keeps its own state
+                    if (state_calls == UINT8_MAX + 1) {
+                        error("too many stateful calls");
+                    }
+
+                    emit(it->second, state_calls++);
+                }
+
+            public:
+                parser(const std::string &expression, std::vector<formula::instruction> &program, std::vector<std::string> &variables, size_t &state_calls)
+                    : expression(expression), program(program), variables(variables), state_calls(state_calls) { }
+
+                void parse() {
+                    parse_or();
+                    skip_whitespace();
+
+                    if (pos != expression.size()) {
+                        error("trailing characters");
+                    }
+                }
+        };
+
+        // NaN is false, like a missing value
+        bool truth(float x) {
+            return x < 0 || x > 0;
+        }
+
+        simde__m256 truth_mask(simde__m256 x) {
+            return simde_mm256_cmp_ps(x, simde_mm256_setzero_ps(), SIMDE_CMP_NEQ_OQ);
+        }
+
+        // Comparison masks become 1 or 0
+        simde__m256 mask_to_bool(simde__m256 mask) {
+            return simde_mm256_and_ps(mask, simde_mm256_set1_ps(1.0f));
+        }
+
+        formula::range full_range() {
+            return { -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), true };
+        }
+
+        // NaN bounds carry no information, fall back to everything
+        formula::range normalize(formula::range r) {
+            return std::isnan(r.min) || std::isnan(r.max) ? full_range() : r;
+        }
+
+        formula::range bool_range(bool can_be_false, bool can_be_true) {
+            return { can_be_false ? 0.0f : 1.0f, can_be_true ? 1.0f : 0.0f, false };
+        }
+
+        bool can_be_true(const formula::range &r) {
+            return r.min < 0 || r.max > 0;
+        }
+
+        bool can_be_false(const formula::range &r) {
+            return r.maybe_nan || (r.min <= 0 && r.max >= 0);
+        }
+
+        formula::range product_range(const formula::range &a, const formula::range &b, float (*op)(float, float)) {
+            float products[] = { op(a.min, b.min), op(a.min, b.max), op(a.max, b.min), op(a.max, b.max) };
+
+            return normalize({ *std::min_element(std::begin(products), std::end(products)), 
+                *std::max_element(std::begin(products), std::end(products)), a.maybe_nan || b.maybe_nan });
+        }
+
+        template <typename F>
+        void apply_binary(float *a, const float *b, F op) {
+            for (size_t i = 0; i < BLOCK_SIZE; i += VECTOR_WIDTH) {
+                simde__m256 x = simde_mm256_loadu_ps(a + i);
+                simde__m256 y = simde_mm256_loadu_ps(b + i);
+                simde_mm256_storeu_ps(a + i, op(x, y));
+            }
+        }
+
+        void fill(float *out, float value) {
+            simde__m256 v = simde_mm256_set1_ps(value);
+
+            for (size_t i = 0; i < BLOCK_SIZE; i += VECTOR_WIDTH) {
+                simde_mm256_storeu_ps(out + i, v);
+            }
+        }
+
+        void widen_bytes(float *out, const uint8_t *bytes, size_t count) {
+            uint8_t tail[VECTOR_WIDTH];
+
+            for (size_t i = 0; i < BLOCK_SIZE; i += VECTOR_WIDTH) {
+                const uint8_t *src = bytes + i;
+
+                // Pad the last partial vector instead of reading past the column
+                if (i + VECTOR_WIDTH > count) {
+                    std::memset(tail, 0, sizeof(tail));
+
+                    if (i < count) {
+                        std::memcpy(tail, src, count - i);
+                    }
+
+                    src = tail;
+                }
+
+                simde__m128i b = simde_mm_loadl_epi64(reinterpret_cast<const simde__m128i *>(src));
+                simde_mm256_storeu_ps(out + i, simde_mm256_cvtepi32_ps(simde_mm256_cvtepu8_epi32(b)));
+            }
+        }
+    }
+
+    formula::formula() { }
+
+    formula::formula(std::string_view expression) : expression(expression) {
+        compile();
+    }
+
+    formula::formula(std::string_view expression, native_decoder native) : expression(expression), native(native) {
+        compile();
+    }
+
+    void formula::compile() {
+        program.clear();
+        variables.clear();
+        required_bytes = 0;
+        state_size = 0;
+        stack_depth = 0;
+        affine_valid = false;
+
+        if (expression.empty()) {
+            return;
+        }
+
+        size_t state_calls = 0;
+
+        parser(expression, program, variables, state_calls).parse();
+        state_size = state_calls * STATE_PER_CALL;
+
+        size_t depth = 0;
+
+        for (const instruction &ins : program) {
+            switch (ins.op) {
+                case opcode::push_byte:
+                    required_bytes = std::max<size_t>(required_bytes, ins.index + 1);
+                    [[fallthrough]];
+                case opcode::push_const:
+                case opcode::push_var:
+                    depth++;
+                    break;
+                case opcode::neg:
+                case opcode::logical_not:
+                case opcode::integrate:
+                case opcode::prev:
+                case opcode::rate:
+                    break;
+                default:
+                    depth--;
+                    break;
+            }
+
+            stack_depth = std::max(stack_depth, depth);
+        }
+
+        if (stack_depth > MAX_STACK) {
+            throw std::invalid_argument("Formula \"" + expression + "\" is nested too deeply");
+        }
+
+        affine_valid = variables.empty() && state_size == 0 && classify_affine();
+    }
+
+    bool formula::classify_affine() {
+        // Symbolic stack, stage is the first step of the form that is still unused
+        struct term {
+            bool constant;
+            float value;
+            affine form;
+            int stage;
+        };
+
+        std::vector<term> stack;
+        stack.reserve(stack_depth);
+
+        // -(y + offset) is (-y) + (-offset) and a negated factor negates the whole product exactly
+        auto negate = [](term &t) noexcept {
+            if (t.constant) {
+                t.value = -t.value;
+                return;
+            }
+
+            t.form.scale = -t.form.scale;
+            t.stage = std::max(t.stage, 1);
+
+            if (t.stage > 4) {
+                t.form.offset = -t.form.offset;
+            }
+        };
+
+        auto add = [](term &t, float c) noexcept {
+            if (t.stage == 0) {
+                t.form.bias = c;
+                t.stage = 1;
+            }
+            else if (t.stage <= 4) {
+                t.form.offset = c;
+                t.stage = 5;
+            }
+            else {
+                return false;
+            }
+
+            return true;
+        };
+
+        // The factor slots may only hold a sign so far, multiplying keeps it
+        auto multiply = [](term &t, float c) noexcept {
+            if (t.stage <= 1) {
+                t.form.scale *= c;
+                t.stage = 2;
+            }
+            else if (t.stage <= 3) {
+                t.form.post_scale *= c;
+                t.stage = 4;
+            }
+            else {
+                return false;
+            }
+
+            return true;
+        };
+
+        for (const instruction &ins : program) {
+            switch (ins.op) {
+                case opcode::push_const:
+                    stack.push_back({ true, ins.value, {}, 0 });
+                    continue;
+                case opcode::push_byte:
+                    stack.push_back({ false, 0, { ins.index, 0, false, -0.0f, 1, 1, 1, -0.0f }, 0 });
+                    continue;
+                case opcode::neg:
+                    negate(stack.back());
+                    continue;
+                case opcode::add:
+                case opcode::sub:
+                case opcode::mul:
+                case opcode::div:
+                    break;
+                default:
+                    return false;
+            }
+
+            term b = stack.back();
+            stack.pop_back();
+            term &a = stack.back();
+
+            if (a.constant && b.constant) {
+                switch (ins.op) {
+                    case opcode::add: a.value = a.value + b.value; break;
+                    case opcode::sub: a.value = a.value - b.value; break;
+                    case opcode::mul: a.value = a.value * b.value; break;
+                    default: a.value = a.value / b.value; break;
+                }
+
+                continue;
+            }
+
+            if (!a.constant && !b.constant) {
+                // 256*A+B with the terms in either order, exact for byte values
+                term &high = b.stage == 0 ? a : b;
+                const term &low = b.stage == 0 ? b : a;
+
+                if (ins.op != opcode::add || high.form.word || low.form.word || low.stage != 0 || high.stage != 2
+                    || high.form.scale != 256 || !(high.form.bias == 0 && std::signbit(high.form.bias))) {
+                    return false;
+                }
+
+                a.form = { high.form.first, low.form.first, true, -0.0f, 1, 1, 1, -0.0f };
+                a.stage = 0;
+                continue;
+            }
+
+            bool valid;
+
+            switch (ins.op) {
+                case opcode::add:
+                    valid = a.constant ? add(b, a.value) : add(a, b.value);
+                    break;
+                case opcode::sub:
+                    // c - y is c + (-y) and y - c is y + (-c)
+                    if (a.constant) {
+                        negate(b);
+                        valid = add(b, a.value);
+                    }
+                    else {
+                        valid = add(a, -b.value);
+                    }
+                    break;
+                case opcode::mul:
+                    valid = a.constant ? multiply(b, a.value) : multiply(a, b.value);
+                    break;
+                default:
+                    valid = !a.constant && a.stage <= 2;
+
+                    if (valid) {
+                        a.form.divisor = b.value;
+                        a.stage = 3;
+                    }
+                    break;
+            }
+
+            if (!valid) {
+                return false;
+            }
+
+            if (a.constant) {
+                a = b;
+            }
+        }
+
+        if (stack.size() != 1 || stack.back().constant) {
+            return false;
+        }
+
+        affine_form = stack.back().form;
+        return true;
+    }
+
+    float formula::evaluate(const uint8_t *data, size_t size) const {
+        if (native != nullptr) {
+            return native(data, size);
+        }
+
+        if (program.empty() || size < required_bytes || !variables.empty() || state_size != 0) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return execute(data, nullptr, 0, nullptr);
+    }
+
+    float formula::evaluate(const float *values) const {
+        return evaluate(values, 0, nullptr);
+    }
+
+    float formula::evaluate(const float *values, uint64_t timestamp, double *state) const {
+        if (program.empty() || required_bytes != 0 || (state_size != 0 && state == nullptr)) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        return execute(nullptr, values, timestamp, state);
+    }
+
+    float formula::execute(const uint8_t *data, const float *values, uint64_t timestamp, double *state) const {
+        float stack[MAX_STACK];
+        size_t sp = 0;
+
+        for (const instruction &ins : program) {
+            switch (ins.op) {
+                case opcode::push_const:
+                    stack[sp++] = ins.value;
+                    break;
+                case opcode::push_byte:
+                    stack[sp++] = data[ins.index];
+                    break;
+                case opcode::add:
+                    sp--;
+                    stack[sp - 1] += stack[sp];
+                    break;
+                case opcode::sub:
+                    sp--;
+                    stack[sp - 1] -= stack[sp];
+                    break;
+                case opcode::mul:
+                    sp--;
+                    stack[sp - 1] *= stack[sp];
+                    break;
+                case opcode::div:
+                    sp--;
+                    stack[sp - 1] /= stack[sp];
+                    break;
+                case opcode::neg:
+                    stack[sp - 1] = -stack[sp - 1];
+                    break;
+                case opcode::push_var:
+                    stack[sp++] = values[ins.index];
+                    break;
+                case opcode::lt:
+                    sp--;
+                    stack[sp - 1] = stack[sp - 1] < stack[sp];
+                    break;
+                case opcode::le:
+                    sp--;
+                    stack[sp - 1] = stack[sp - 1] <= stack[sp];
+                    break;
+                case opcode::gt:
+                    sp--;
+                    stack[sp - 1] = stack[sp - 1] > stack[sp];
+                    break;
+                case opcode::ge:
+                    sp--;
+                    stack[sp - 1] = stack[sp - 1] >= stack[sp];
+                    break;
+                case opcode::eq:
+                    sp--;
+                    stack[sp - 1] = stack[sp - 1] == stack[sp];
+                    break;
+                case opcode::ne:
+                    sp--;
+                    stack[sp - 1] = stack[sp - 1] < stack[sp] || stack[sp - 1] > stack[sp];
+                    break;
+                case opcode::logical_and:
+                    sp--;
+                    stack[sp - 1] = truth(stack[sp - 1]) && truth(stack[sp]);
+                    break;
+                case opcode::logical_or:
+                    sp--;
+                    stack[sp - 1] = truth(stack[sp - 1]) || truth(stack[sp]);
+                    break;
+                case opcode::logical_not:
+                    stack[sp - 1] = !truth(stack[sp - 1]);
+                    break;
+                case opcode::integrate: {
+                    // Trapezoidal sum, state is the sum, the last value and its timestamp
+                    double *s = state + ins.index * STATE_PER_CALL;
+                    float value = stack[sp - 1];
+
+                    if (!std::isnan(value)) {
+                        if (s[2] != 0) {
+                            s[0] += (value + s[1]) / 2 * (timestamp - s[2]) / 1000;
+                        }
+
+                        s[1] = value;
+                        s[2] = timestamp;
+                    }
+
+                    stack[sp - 1] = s[0];
+                    break;
+                }
+                case opcode::prev:
+                case opcode::rate: {
+                    // State is the last value and its timestamp, missing values are skipped
+                    double *s = state + ins.index * STATE_PER_CALL;
+                    float value = stack[sp - 1];
+                    float result = std::numeric_limits<float>::quiet_NaN();
+
+                    if (s[1] != 0) {
+                        if (ins.op == opcode::prev) {
+                            result = s[0];
+                        }
+                        else if (timestamp > s[1]) {
+                            result = (value - s[0]) * 1000 / (timestamp - s[1]);
+                        }
+                    }
+
+                    if (!std::isnan(value)) {
+                        s[0] = value;
+                        s[1] = timestamp;
+                    }
+
+                    stack[sp - 1] = result;
+                    break;
+                }
+            }
+        }
+
+        return stack[0];
+    }
+
+    formula::range formula::evaluate_range(const range *ranges) const {
+        if (program.empty()) {
+            return full_range();
+        }
+
+        range stack[MAX_STACK];
+        size_t sp = 0;
+
+        for (const instruction &ins : program) {
+            range &a = stack[sp >= 2 ? sp - 2 : 0];
+            range b = sp > 0 ? stack[sp - 1] : range();
+
+            switch (ins.op) {
+                case opcode::push_const:
+                    stack[sp++] = { ins.value, ins.value, std::isnan(ins.value) };
+                    break;
+                case opcode::push_byte:
+                    stack[sp++] = { 0.0f, 255.0f, false };
+                    break;
+                case opcode::push_var:
+                    stack[sp++] = normalize(ranges[ins.index]);
+                    break;
+                case opcode::add:
+                    a = normalize({ a.min + b.min, a.max + b.max, a.maybe_nan || b.maybe_nan });
+                    sp--;
+                    break;
+                case opcode::sub:
+                    a = normalize({ a.min - b.max, a.max - b.min, a.maybe_nan || b.maybe_nan });
+                    sp--;
+                    break;
+                case opcode::mul:
+                    a = product_range(a, b, [](float x, float y) { return x * y; });
+                    sp--;
+                    break;
+                case opcode::div:
+                    // A divisor spanning zero can produce anything
+                    a = b.min <= 0 && b.max >= 0 ? full_range() : product_range(a, b, [](float x, float y) { return x / y; });
+                    sp--;
+                    break;
+                case opcode::neg:
+                    stack[sp - 1] = { -b.max, -b.min, b.maybe_nan };
+                    break;
+                case opcode::lt:
+                    a = bool_range(a.maybe_nan || b.maybe_nan || a.max >= b.min, a.min < b.max);
+                    sp--;
+                    break;
+                case opcode::le:
+                    a = bool_range(a.maybe_nan || b.maybe_nan || a.max > b.min, a.min <= b.max);
+                    sp--;
+                    break;
+                case opcode::gt:
+                    a = bool_range(a.maybe_nan || b.maybe_nan || a.min <= b.max, a.max > b.min);
+                    sp--;
+                    break;
+                case opcode::ge:
+                    a = bool_range(a.maybe_nan || b.maybe_nan || a.min < b.max, a.max >= b.min);
+                    sp--;
+                    break;
+                case opcode::eq:
+                case opcode::ne: {
+                    bool overlap = a.min <= b.max && b.min <= a.max;
+                    bool always_equal = a.min == a.max && b.min == b.max && a.min == b.min;
+                    bool maybe_nan = a.maybe_nan || b.maybe_nan;
+
+                    a = ins.op == opcode::eq 
+                        ? bool_range(maybe_nan || !always_equal, overlap) 
+                        : bool_range(maybe_nan || overlap, !always_equal);
+                    sp--;
+                    break;
+                }
+                case opcode::logical_and:
+                    a = bool_range(can_be_false(a) || can_be_false(b), can_be_true(a) && can_be_true(b));
+                    sp--;
+                    break;
+                case opcode::logical_or:
+                    a = bool_range(can_be_false(a) && can_be_false(b), can_be_true(a) || can_be_true(b));
+                    sp--;
+                    break;
+                case opcode::logical_not:
+                    stack[sp - 1] = bool_range(can_be_true(b), can_be_false(b));
+                    break;
+                case opcode::integrate:
+                case opcode::prev:
+                case opcode::rate:
+                    stack[sp - 1] = full_range();
+                    break;
+            }
+        }
+
+        return stack[0];
+    }
+
+    void formula::evaluate_columns(const uint8_t *const *columns, size_t column_count, const uint8_t *lengths, size_t count, float *out) const {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+
+        if (program.empty() || column_count < required_bytes || !variables.empty() || state_size != 0) {
+            std::fill(out, out + count, nan);
+            return;
+        }
+
+        // One block sized column per stack slot
+        std::vector<float> stack(stack_depth * BLOCK_SIZE);
+
+        for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+            size_t n = std::min(BLOCK_SIZE, count - start);
+            // Number of stack slots in use, slot i starts at stack[i * BLOCK_SIZE]
+            size_t sp = 0;
+            auto slot = [&stack](size_t i) noexcept { return stack.data() + i * BLOCK_SIZE; };
+
+            for (const instruction &ins : program) {
+                switch (ins.op) {
+                    case opcode::push_const:
+                        fill(slot(sp++), ins.value);
+                        break;
+                    case opcode::push_byte:
+                        widen_bytes(slot(sp++), columns[ins.index] + start, n);
+                        break;
+                    case opcode::add:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return simde_mm256_add_ps(x, y);
+                        });
+                        sp--;
+                        break;
+                    case opcode::sub:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return simde_mm256_sub_ps(x, y);
+                        });
+                        sp--;
+                        break;
+                    case opcode::mul:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return simde_mm256_mul_ps(x, y);
+                        });
+                        sp--;
+                        break;
+                    case opcode::div:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return simde_mm256_div_ps(x, y);
+                        });
+                        sp--;
+                        break;
+                    case opcode::neg:
+                        apply_binary(slot(sp - 1), slot(sp - 1), [](simde__m256 x, simde__m256) {
+                            // Flips the sign bit like the scalar -x, 0 - x would turn -0 into +0
+                            return simde_mm256_xor_ps(x, simde_mm256_set1_ps(-0.0f));
+                        });
+                        break;
+                    case opcode::lt:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_cmp_ps(x, y, SIMDE_CMP_LT_OQ));
+                        });
+                        sp--;
+                        break;
+                    case opcode::le:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_cmp_ps(x, y, SIMDE_CMP_LE_OQ));
+                        });
+                        sp--;
+                        break;
+                    case opcode::gt:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_cmp_ps(x, y, SIMDE_CMP_GT_OQ));
+                        });
+                        sp--;
+                        break;
+                    case opcode::ge:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_cmp_ps(x, y, SIMDE_CMP_GE_OQ));
+                        });
+                        sp--;
+                        break;
+                    case opcode::eq:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_cmp_ps(x, y, SIMDE_CMP_EQ_OQ));
+                        });
+                        sp--;
+                        break;
+                    case opcode::ne:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_cmp_ps(x, y, SIMDE_CMP_NEQ_OQ));
+                        });
+                        sp--;
+                        break;
+                    case opcode::logical_and:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_and_ps(truth_mask(x), truth_mask(y)));
+                        });
+                        sp--;
+                        break;
+                    case opcode::logical_or:
+                        apply_binary(slot(sp - 2), slot(sp - 1), [](simde__m256 x, simde__m256 y) {
+                            return mask_to_bool(simde_mm256_or_ps(truth_mask(x), truth_mask(y)));
+                        });
+                        sp--;
+                        break;
+                    case opcode::logical_not:
+                        apply_binary(slot(sp - 1), slot(sp - 1), [](simde__m256 x, simde__m256) {
+                            return simde_mm256_andnot_ps(truth_mask(x), simde_mm256_set1_ps(1.0f));
+                        });
+                        break;
+                    case opcode::push_var:
+                    case opcode::integrate:
+                    case opcode::prev:
+                    case opcode::rate:
+                        // Channel values and stateful calls never get here, see above
+                        break;
+                }
+            }
+
+            // Responses too short for the formula have no value
+            for (size_t i = 0; i < n; i++) {
+                out[start + i] = lengths[start + i] < required_bytes ? nan : stack[i];
+            }
+        }
+    }
+
+    void formula::set_native(native_decoder native) {
+        this->native = native;
+    }
+
+    bool formula::has_native() const {
+        return native != nullptr;
+    }
+
+    bool formula::empty() const {
+        return program.empty();
+    }
+
+    const std::string &formula::get_expression() const {
+        return expression;
+    }
+
+    const std::vector<formula::instruction> &formula::get_program() const {
+        return program;
+    }
+
+    const std::vector<std::string> &formula::get_variables() const {
+        return variables;
+    }
+
+    size_t formula::get_state_size() const {
+        return state_size;
+    }
+
+    size_t formula::get_required_bytes() const {
+        return required_bytes;
+    }
+
+    bool formula::is_affine() const {
+        return affine_valid;
+    }
+
+    const formula::affine &formula::get_affine() const {
+        return affine_form;
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace obd2_server {
+    // Arithmetic formula over the payload bytes of a response (A = first byte, B = second, ...)
+    // or over named channel values ([Engine RPM]). Comparisons and logic yield 1 or 0, NaN compares false.
+    // Stateful functions keep their state outside the formula: integrate(x) accumulates x over time
+    // in seconds, prev(x) is the previous value of x and rate(x) its change per second.
+    class formula {
+        public:
+            // Compiled decoder of the same expression, e.g. from standard_decoders.h
+            using native_decoder = float (*)(const uint8_t *data, size_t size);
+
+            enum class opcode : uint8_t {
+                push_const,
+                push_byte,
+                add,
+                sub,
+                mul,
+                div,
+                neg,
+                push_var,
+                lt,
+                le,
+                gt,
+                ge,
+                eq,
+                ne,
+                logical_and,
+                logical_or,
+                logical_not,
+                integrate,
+                prev,
+                rate
+            };
+
+            struct instruction {
+                opcode op;
+                uint8_t index;
+                float value;
+            };
+
+            // Bounds of a value, maybe_nan if it can also be missing
+            struct range {
+                float min;
+                float max;
+                bool maybe_nan;
+            };
+
+            // value = ((((x + bias) * scale) / divisor) * post_scale) + offset, x is byte A[first] or
+            // the word 256*A[first]+A[second]. Unused steps hold identities (-0 for the additions,
+            // 1 otherwise), so evaluating all steps rounds exactly like the program.
+            struct affine {
+                uint8_t first;
+                uint8_t second;
+                bool word;
+                float bias;
+                float scale;
+                float divisor;
+                float post_scale;
+                float offset;
+            };
+
+            static constexpr size_t MAX_BYTES = 26;
+            static constexpr size_t MAX_STACK = 32;
+            static constexpr size_t MAX_VARIABLES = 256;
+            // State values per stateful function call
+            static constexpr size_t STATE_PER_CALL = 3;
+
+        private:
+            std::string expression;
+            std::vector<instruction> program;
+            std::vector<std::string> variables;
+            size_t required_bytes = 0;
+            size_t stack_depth = 0;
+            size_t state_size = 0;
+            native_decoder native = nullptr;
+            affine affine_form = {};
+            bool affine_valid = false;
+
+            void compile();
+            bool classify_affine();
+            float execute(const uint8_t *data, const float *values, uint64_t timestamp, double *state) const;
+
+        public:
+            formula();
+            formula(std::string_view expression);
+            // native has to decode exactly like the expression, evaluate(data, size) then calls it instead
+            formula(std::string_view expression, native_decoder native);
+
+            // Decodes a single response, NaN if it is shorter than the formula requires
+            float evaluate(const uint8_t *data, size_t size) const;
+            // Evaluates a formula over channel values, values[i] belongs to get_variables()[i]
+            float evaluate(const float *values) const;
+            // As above for formulas with stateful functions. state holds get_state_size() zero initialized
+            // values that are carried from one call to the next, timestamps are in ms.
+            float evaluate(const float *values, uint64_t timestamp, double *state) const;
+            // Bounds of every result possible with the variables within their ranges, payload bytes span 0-255
+            range evaluate_range(const range *ranges) const;
+            
+            // Decodes count responses at once. columns[k][i] is byte k of response i, 
+            // lengths[i] its payload length.
+            void evaluate_columns(const uint8_t *const *columns, size_t column_count, const uint8_t *lengths, size_t count, float *out) const;
+
+            // Replaces the native decoder, nullptr returns to interpreting the program
+            void set_native(native_decoder native);
+            bool has_native() const;
+
+            bool empty() const;
+            const std::string &get_expression() const;
+            const std::vector<instruction> &get_program() const;
+            const std::vector<std::string> &get_variables() const;
+            size_t get_state_size() const;
+            size_t get_required_bytes() const;
+            // Whether the formula reduces to an affine form of one byte or word, see affine
+            bool is_affine() const;
+            const affine &get_affine() const;
+    };
+}
@@ -0,0 +1,282 @@
+#include "formula_jit.h"
+
+#include <cstring>
+#include <string_view>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace obd2_server {
+    // The System V calling convention passes data in rdi, size in rsi and returns in xmm0
+    static constexpr size_t MAX_REGISTERS = 16;
+    static constexpr size_t CODE_ALIGNMENT = 16;
+    static constexpr uint32_t QUIET_NAN = 0x7FC00000;
+    static constexpr uint32_t SIGN_BIT = 0x80000000;
+    static constexpr uint8_t PP_NONE = 0;
+    static constexpr uint8_t PP_66 = 1;
+    static constexpr uint8_t PP_F3 = 2;
+
+    namespace {
+        class assembler {
+            private:
+                std::vector<uint8_t> &code;
+
+                void imm32(uint32_t value) {
+                    for (int i = 0; i < 4; i++) {
+                        code.push_back(uint8_t(value >> (i * 8)));
+                    }
+                }
+
+                void modrm(size_t reg, size_t rm) {
+                    code.push_back(uint8_t(0xC0 | (reg & 7) << 3 | (rm & 7)));
+                }
+
+                // Three byte VEX prefix for the 0F opcode map, pp selects the implied 66/F3 prefix.
+                // vvvv is the extra source register, 0 where the instruction has none.
+                void vex(uint8_t pp, size_t reg, size_t vvvv, size_t rm, uint8_t opcode) {
+                    code.push_back(0xC4);
+                    code.push_back(uint8_t((reg >= 8 ? 0 : 0x80) | 0x40 | (rm >= 8 ? 0 : 0x20) | 0x01));
+                    code.push_back(uint8_t((~vvvv & 0x0F) << 3 | pp));
+                    code.push_back(opcode);
+                    modrm(reg, rm);
+                }
+
+            public:
+                static constexpr uint8_t VADDSS = 0x58;
+                static constexpr uint8_t VSUBSS = 0x5C;
+                static constexpr uint8_t VMULSS = 0x59;
+                static constexpr uint8_t VDIVSS = 0x5E;
+
+                assembler(std::vector<uint8_t> &code) : code(code) { }
+
+                // mov eax, value
+                void mov_eax(uint32_t value) {
+                    code.push_back(0xB8);
+                    imm32(value);
+                }
+
+                // vmovd xmm, eax
+                void movd_to_xmm(size_t xmm) {
+                    vex(PP_66, xmm, 0, 0, 0x6E);
+                }
+
+                // vmovd eax, xmm
+                void movd_from_xmm(size_t xmm) {
+                    vex(PP_66, xmm, 0, 0, 0x7E);
+                }
+
+                // xor eax, value
+                void xor_eax(uint32_t value) {
+                    code.push_back(0x35);
+                    imm32(value);
+                }
+
+                // movzx eax, byte [rdi + offset]
+                void load_byte(uint8_t offset) {
+                    code.insert(code.end(), { 0x0F, 0xB6, 0x47, offset });
+                }
+
+                // vxorps xmm, xmm, xmm breaks the dependency of vcvtsi2ss on the old register value
+                void clear(size_t xmm) {
+                    vex(PP_NONE, xmm, xmm, xmm, 0x57);
+                }
+
+                // vcvtsi2ss xmm, xmm, eax
+                void convert(size_t xmm) {
+                    vex(PP_F3, xmm, xmm, 0, 0x2A);
+                }
+
+                // vaddss, vsubss, vmulss or vdivss dst, dst, src
+                void arithmetic(uint8_t opcode, size_t dst, size_t src) {
+                    vex(PP_F3, dst, dst, src, opcode);
+                }
+
+                // cmp rsi, value
+                void cmp_rsi(uint32_t value) {
+                    code.insert(code.end(), { 0x48, 0x81, 0xFE });
+                    imm32(value);
+                }
+
+                // jae over the next skip bytes
+                void jae(uint8_t skip) {
+                    code.insert(code.end(), { 0x73, skip });
+                }
+
+                void ret() {
+                    code.push_back(0xC3);
+                }
+        };
+    }
+
+    formula_jit::formula_jit() { }
+
+    formula_jit::~formula_jit() {
+        for (const mapping &m : mappings) {
+            munmap(m.address, m.size);
+        }
+    }
+
+    bool formula_jit::available() {
+#if defined(__x86_64__)
+        return __builtin_cpu_supports("avx");
+#else
+        return false;
+#endif
+    }
+
+    bool formula_jit::emit(const formula &f, std::vector<uint8_t> &code) {
+        using opcode = formula::opcode;
+
+        if (f.empty() || !f.get_variables().empty() || f.get_state_size() != 0) {
+            return false;
+        }
+
+        std::vector<uint8_t> body;
+        assembler a(body);
+        size_t depth = 0;
+
+        for (const formula::instruction &ins : f.get_program()) {
+            switch (ins.op) {
+                case opcode::push_const: {
+                    if (depth == MAX_REGISTERS) {
+                        return false;
+                    }
+
+                    uint32_t bits;
+                    std::memcpy(&bits, &ins.value, sizeof(bits));
+                    a.mov_eax(bits);
+                    a.movd_to_xmm(depth++);
+                    break;
+                }
+                case opcode::push_byte:
+                    if (depth == MAX_REGISTERS) {
+                        return false;
+                    }
+
+                    a.load_byte(ins.index);
+                    a.clear(depth);
+                    a.convert(depth++);
+                    break;
+                case opcode::add:
+                    a.arithmetic(assembler::VADDSS, depth - 2, depth - 1);
+                    depth--;
+                    break;
+                case opcode::sub:
+                    a.arithmetic(assembler::VSUBSS, depth - 2, depth - 1);
+                    depth--;
+                    break;
+                case opcode::mul:
+                    a.arithmetic(assembler::VMULSS, depth - 2, depth - 1);
+                    depth--;
+                    break;
+                case opcode::div:
+                    a.arithmetic(assembler::VDIVSS, depth - 2, depth - 1);
+                    depth--;
+                    break;
+                case opcode::neg:
+                    // Flips the sign bit like the interpreter's -x
+                    a.movd_from_xmm(depth - 1);
+                    a.xor_eax(SIGN_BIT);
+                    a.movd_to_xmm(depth - 1);
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        a.ret();
+        assembler prologue(code);
+
+        // Responses shorter than the formula requires decode to NaN
+        if (f.get_required_bytes() > 0) {
+            std::vector<uint8_t> nan;
+            assembler n(nan);
+            n.mov_eax(QUIET_NAN);
+            n.movd_to_xmm(0);
+            n.ret();
+
+            prologue.cmp_rsi(uint32_t(f.get_required_bytes()));
+            prologue.jae(uint8_t(nan.size()));
+            code.insert(code.end(), nan.begin(), nan.end());
+        }
+
+        code.insert(code.end(), body.begin(), body.end());
+        return true;
+    }
+
+    std::vector<formula::native_decoder> formula_jit::compile(const std::vector<const formula *> &formulas) {
+        std::vector<formula::native_decoder> decoders(formulas.size(), nullptr);
+
+        if (!available()) {
+            return decoders;
+        }
+
+        std::vector<uint8_t> code;
+        std::vector<size_t> offsets(formulas.size(), SIZE_MAX);
+        std::unordered_map<std::string_view, size_t> emitted;
+
+        for (size_t i = 0; i < formulas.size(); i++) {
+            const std::string &expression = formulas[i]->get_expression();
+            auto cached = cache.find(expression);
+
+            if (cached != cache.end()) {
+                decoders[i] = cached->second;
+                continue;
+            }
+
+            auto e = emitted.find(expression);
+
+            if (e != emitted.end()) {
+                offsets[i] = e->second;
+                continue;
+            }
+
+            code.resize((code.size() + CODE_ALIGNMENT - 1) / CODE_ALIGNMENT * CODE_ALIGNMENT, 0xCC);
+            size_t offset = code.size();
+
+            if (emit(*formulas[i], code)) {
+                offsets[i] = offset;
+            }
+            else {
+                code.resize(offset);
+                cache.emplace(expression, nullptr);
+            }
+
+            emitted.emplace(expression, offsets[i]);
+        }
+
+        if (code.empty()) {
+            return decoders;
+        }
+
+        // Written while writable, then sealed read only executable for good
+        size_t page = size_t(sysconf(_SC_PAGESIZE));
+        size_t size = (code.size() + page - 1) / page * page;
+        void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (address == MAP_FAILED) {
+            return decoders;
+        }
+
+        std::memcpy(address, code.data(), code.size());
+
+        if (mprotect(address, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(address, size);
+            return decoders;
+        }
+
+        mappings.push_back({ address, size });
+
+        for (size_t i = 0; i < formulas.size(); i++) {
+            if (offsets[i] == SIZE_MAX) {
+                continue;
+            }
+
+            // Function pointers to data are implementation defined, but POSIX guarantees them for mapped code
+            formula::native_decoder decoder = reinterpret_cast<formula::native_decoder>(static_cast<uint8_t *>(address) + offsets[i]);
+            decoders[i] = decoder;
+            cache.emplace(formulas[i]->get_expression(), decoder);
+        }
+
+        return decoders;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../formula/formula.h"
+
+namespace obd2_server {
+    // Translates arithmetic payload formulas into x86-64 machine code with VEX encoded scalar ops, one
+    // register per stack slot. Legacy SSE encodings would pay the SSE/AVX transition after the AVX code
+    // around them on every call. Results match the interpreter bit for bit. Code lives in read only executable
+    // mappings that stay valid as long as the jit, compiled formulas are cached by their expression.
+    class formula_jit {
+        private:
+            struct mapping {
+                void *address;
+                size_t size;
+            };
+
+            std::vector<mapping> mappings;
+            std::unordered_map<std::string, formula::native_decoder> cache;
+
+            static bool emit(const formula &f, std::vector<uint8_t> &code);
+
+        public:
+            formula_jit();
+            formula_jit(const formula_jit &) = delete;
+            formula_jit &operator=(const formula_jit &) = delete;
+            ~formula_jit();
+
+            // Machine code of every formula, nullptr where a formula uses anything but arithmetic over payload
+            // bytes, or where code cannot be mapped executable. New code of one call shares a single mapping.
+            std::vector<formula::native_decoder> compile(const std::vector<const formula *> &formulas);
+            // Whether this platform can run the generated code, which needs AVX
+            static bool available();
+    };
+}
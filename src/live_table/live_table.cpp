@@ -0,0 +1,197 @@
+#include "live_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace obd2_server {
+    live_table::live_table() { }
+
+    live_table::live_table(const std::string &name, const std::vector<std::string> &ids) : name(name), owner(true) {
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create shared memory " + name + ": " + std::strerror(errno));
+        }
+
+        memory_size = sizeof(live_table_header) + ids.size() * sizeof(live_table_entry);
+
+        if (ftruncate(fd, memory_size) < 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot resize shared memory " + name + ": " + std::strerror(errno));
+        }
+
+        map(fd, PROT_READ | PROT_WRITE);
+
+        live_table_header *header = get_header();
+        live_table_entry *entries = get_entries();
+
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version = VERSION;
+        header->entry_count = ids.size();
+        header->entry_size = sizeof(live_table_entry);
+        header->sequence.store(0, std::memory_order_relaxed);
+
+        for (size_t i = 0; i < ids.size(); i++) {
+            entries[i].timestamp.store(0, std::memory_order_relaxed);
+            entries[i].value.store(0, std::memory_order_relaxed);
+            entries[i].status.store(live_status::no_response, std::memory_order_relaxed);
+            std::memcpy(entries[i].id, ids[i].data(), std::min(ids[i].size(), sizeof(entries[i].id)));
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    live_table::live_table(const std::string &name) : name(name) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open shared memory " + name + ": " + std::strerror(errno));
+        }
+
+        struct stat st;
+
+        if (fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(live_table_header)) {
+            close(fd);
+            throw std::runtime_error("Invalid shared memory " + name);
+        }
+
+        memory_size = st.st_size;
+        map(fd, PROT_READ);
+
+        live_table_header *header = get_header();
+
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION 
+            || header->entry_size != sizeof(live_table_entry)
+            || sizeof(live_table_header) + header->entry_count * sizeof(live_table_entry) > memory_size) {
+            unmap();
+            throw std::runtime_error("Incompatible shared memory " + name);
+        }
+    }
+
+    live_table::live_table(live_table &&t) 
+        : name(std::move(t.name)), memory(t.memory), memory_size(t.memory_size), owner(t.owner) {
+        t.memory = nullptr;
+        t.owner = false;
+    }
+
+    live_table::~live_table() {
+        unmap();
+    }
+
+    live_table &live_table::operator=(live_table &&t) {
+        if (this != &t) {
+            unmap();
+            name = std::move(t.name);
+            memory = t.memory;
+            memory_size = t.memory_size;
+            owner = t.owner;
+            t.memory = nullptr;
+            t.owner = false;
+        }
+
+        return *this;
+    }
+
+    live_table_header *live_table::get_header() const {
+        return static_cast<live_table_header *>(memory);
+    }
+
+    live_table_entry *live_table::get_entries() const {
+        return reinterpret_cast<live_table_entry *>(static_cast<uint8_t *>(memory) + sizeof(live_table_header));
+    }
+
+    void live_table::map(int fd, int protection) {
+        memory = mmap(nullptr, memory_size, protection, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+
+            if (owner) {
+                shm_unlink(name.c_str());
+            }
+
+            throw std::runtime_error("Cannot map shared memory " + name + ": " + std::strerror(errno));
+        }
+    }
+
+    void live_table::unmap() {
+        if (memory == nullptr) {
+            return;
+        }
+
+        munmap(memory, memory_size);
+        memory = nullptr;
+
+        if (owner) {
+            shm_unlink(name.c_str());
+            owner = false;
+        }
+    }
+
+    bool live_table::is_open() const {
+        return memory != nullptr;
+    }
+
+    size_t live_table::size() const {
+        return memory ? get_header()->entry_count : 0;
+    }
+
+    void live_table::begin_update() {
+        std::atomic<uint32_t> &sequence = get_header()->sequence;
+
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void live_table::set(size_t index, float value, uint64_t timestamp, live_status status) {
+        live_table_entry &entry = get_entries()[index];
+
+        entry.timestamp.store(timestamp, std::memory_order_relaxed);
+        entry.value.store(value, std::memory_order_relaxed);
+        entry.status.store(status, std::memory_order_relaxed);
+    }
+
+    void live_table::end_update() {
+        std::atomic<uint32_t> &sequence = get_header()->sequence;
+
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void live_table::read(std::vector<live_value> &values) const {
+        const std::atomic<uint32_t> &sequence = get_header()->sequence;
+        const live_table_entry *entries = get_entries();
+        size_t count = size();
+
+        values.resize(count);
+
+        while (true) {
+            uint32_t begin = sequence.load(std::memory_order_acquire);
+
+            // The writer is in the middle of an update
+            if (begin & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                values[i].timestamp = entries[i].timestamp.load(std::memory_order_relaxed);
+                values[i].value = entries[i].value.load(std::memory_order_relaxed);
+                values[i].status = entries[i].status.load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == begin) {
+                return;
+            }
+        }
+    }
+}
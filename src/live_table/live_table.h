@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace obd2_server {
+    enum class live_status : uint32_t {
+        no_response = 0,
+        ok = 1,
+        raw_only = 2
+    };
+
+    // Shared memory layout: a header followed by one entry per request in definition order.
+    // The header sequence is a seqlock, odd while the writer updates the entries. The header is
+    // padded to the entry alignment, so the entries right behind it are aligned.
+    struct alignas(32) live_table_header {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t entry_size;
+        std::atomic<uint32_t> sequence;
+    };
+
+    struct alignas(32) live_table_entry {
+        std::atomic<uint64_t> timestamp;
+        std::atomic<float> value;
+        std::atomic<live_status> status;
+        uint8_t id[16];
+    };
+
+    struct live_value {
+        uint64_t timestamp;
+        float value;
+        live_status status;
+    };
+
+    static_assert(sizeof(live_table_header) % alignof(live_table_entry) == 0, "Entries must follow the header aligned");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free 
+        && std::atomic<float>::is_always_lock_free, "Shared memory atomics must be lock free");
+
+    // Latest value of every request, published through POSIX shared memory
+    class live_table {
+        private:
+            static constexpr char MAGIC[8] = { 'O', 'B', 'D', '2', 'L', 'I', 'V', 'E' };
+            static constexpr uint32_t VERSION = 2;
+
+            std::string name;
+            void *memory = nullptr;
+            size_t memory_size = 0;
+            bool owner = false;
+
+            live_table_header *get_header() const;
+            live_table_entry *get_entries() const;
+            void map(int fd, int protection);
+            void unmap();
+
+        public:
+            live_table();
+            // Creates the segment for the given request ids (byte form), it is removed on destruction
+            live_table(const std::string &name, const std::vector<std::string> &ids);
+            // Maps an existing segment for reading
+            live_table(const std::string &name);
+            live_table(const live_table &) = delete;
+            live_table(live_table &&t);
+            ~live_table();
+
+            live_table &operator=(const live_table &) = delete;
+            live_table &operator=(live_table &&t);
+
+            bool is_open() const;
+            size_t size() const;
+
+            // Writer side, set is only allowed between begin_update and end_update
+            void begin_update();
+            void set(size_t index, float value, uint64_t timestamp, live_status status);
+            void end_update();
+
+            // Reader side, copies a consistent snapshot of all entries
+            void read(std::vector<live_value> &values) const;
+    };
+}
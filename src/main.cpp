@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <atomic>
 #include <cmath>
 #include <cstdint>
@@ -5,35 +6,226 @@
 #include <cstring>
 #include <chrono>
 #include <csignal>
+#include <ctime>
 #include <exception>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <limits>
-#include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <future>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
 #include <obd2.h>
 #include "vehicle/vehicle.h"
 #include "csv_logger/csv_logger.h"
+#include "formula/formula.h"
+#include "formula_jit/formula_jit.h"
+#include "affine_decoder/affine_decoder.h"
+#include "standard_decoders.h"
+#include "raw_log/raw_log.h"
+#include "live_table/live_table.h"
+#include "server/stream_server.h"
+#include "bus_merger/bus_merger.h"
+#include "refresh_controller/refresh_controller.h"
+#include "request_stats/request_stats.h"
+#include "profiler/profiler.h"
+#include "trace/tracer.h"
+#include "csv_index/csv_index.h"
+#include "rollup/rollup.h"
+#include "channel_graph/channel_graph.h"
+#include "rule_engine/rule_engine.h"
+#include "file_watcher/file_watcher.h"
+#include "uuid_table/uuid_table.h"
 
+// One bus request per distinct (ecu, service, pid), the library only fetches raw payloads
+struct bus_exchange {
+    uint32_t ecu;
+    uint8_t service;
+    uint16_t pid;
+    obd2::request request;
+
+    bus_exchange(const obd2_server::request &definition, obd2::obd2 &instance)
+        : ecu(definition.ecu), service(definition.service), pid(definition.pid), request(definition.ecu, definition.service, definition.pid, instance, "", true) { }
+};
+
+// Per cycle view of a channel, decoded locally from the payload of its exchange. It only
+// holds two pointers, so the decode loop stays in cache even for thousands of channels.
+struct live_request {
+    obd2::request *exchange;
+    // Null for raw capture and channels without a formula
+    const obd2_server::formula *decoder;
+
+    const std::vector<uint8_t> &get_raw() const {
+        return exchange->get_raw();
+    }
+
+    float get_value() const {
+        if (decoder == nullptr) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+
+        const std::vector<uint8_t> &raw = get_raw();
+        return decoder->evaluate(raw.data(), raw.size());
+    }
+};
+
+// Channel with a generated decoder, decode<pid, channel> in standard_decoders.h
+struct standard_channel {
+    uint32_t index;
+    uint8_t pid;
+    uint8_t channel;
+};
+
+// Channels in definition order, the hot per cycle views apart from the definitions that are
+// only read for display and export. Decoders are reserved up front and never grow afterwards,
+// since the channels refer to them by address. Exchanges are shared, so a reloaded table keeps
+// polling the requests it has in common with the old one.
+struct request_table {
+    std::vector<std::shared_ptr<bus_exchange>> exchanges;
+    // One per distinct formula
+    std::vector<obd2_server::formula> decoders;
+    std::vector<live_request> channels;
+    std::vector<const obd2_server::request *> definitions;
+    // Channels with affine formulas decode together in one SIMD pass, lane i belongs to
+    // affine_channels[i]. The others are decoded one by one, standard formulas through
+    // standard_decoders::decode and the rest through their formula.
+    obd2_server::affine_decoder affine;
+    std::vector<uint32_t> affine_channels;
+    // Payload of every lane for the current sample, null for lanes nobody wants
+    std::vector<const std::vector<uint8_t> *> affine_payloads;
+    std::vector<standard_channel> standard_channels;
+    std::vector<uint32_t> general_channels;
+    // Service 01 PIDs the engine ECU reported at discovery
+    std::vector<uint8_t> supported_pids;
+
+    size_t size() const { return channels.size(); }
+    live_request &operator[](size_t i) { return channels[i]; }
+    const live_request &operator[](size_t i) const { return channels[i]; }
+    std::vector<live_request>::iterator begin() { return channels.begin(); }
+    std::vector<live_request>::iterator end() { return channels.end(); }
+    std::vector<live_request>::const_iterator begin() const { return channels.begin(); }
+    std::vector<live_request>::const_iterator end() const { return channels.end(); }
+};
+
+// Columns of the decoded log and channels of the raw log for a request table
+struct log_schema {
+    std::vector<std::string> headers;
+    std::vector<int> precisions;
+    std::vector<std::string> raw_ids;
+    std::vector<std::string> live_ids;
+};
+
+// Definition change prepared off the acquisition path, swapped in by the refresh callback
+struct definition_reload {
+    obd2_server::vehicle vehicle;
+    request_table requests;
+    obd2_server::channel_graph virtual_values;
+    obd2_server::rule_engine rules;
+    log_schema schema;
+    // Index of each channel in the old table, NPOS for added or changed ones
+    std::vector<size_t> previous;
+    std::string summary;
+};
+
+struct bus_session {
+    std::string network;
+    size_t index;
+    obd2::obd2 instance;
+    obd2_server::vehicle vehicle;
+    request_table requests;
+    size_t column_offset = 0;
+    bool pinned = false;
+
+    // Only touched by the bus' acquisition thread until it is stopped
+    uint64_t cycles = 0;
+    uint64_t responses = 0;
+    uint64_t timeouts = 0;
+    uint64_t first_timestamp = 0;
+    uint64_t last_timestamp = 0;
+};
+
+void redecode_log(int argc, const char *argv[]);
+void query_log(int argc, const char *argv[]);
+void rollup_log(int argc, const char *argv[]);
 void print_info(obd2::obd2 &instance);
 void print_dtcs(obd2::obd2 &instance);
 void clear_dtcs(obd2::obd2 &instance);
 void print_pids(obd2::obd2 &instance);
 void log_requests(obd2::obd2 &instance, int argc, const char *argv[]);
-std::map<const obd2_server::request *, obd2::request> create_requests(obd2::obd2 &instance, obd2_server::vehicle &vehicle);
-void print_requests(std::map<const obd2_server::request *, obd2::request> &requests);
-float print_request(std::pair<const obd2_server::request *const, obd2::request> &req);
+void log_multi_bus(int argc, const char *argv[]);
+void collect_bus_sample(bus_session &bus, obd2_server::bus_merger &merger);
+void serve_requests(obd2::obd2 &instance, int argc, const char *argv[]);
+void publish_requests(request_table &requests, obd2_server::stream_server &server);
+void decode_requests(request_table &requests, float *out, const std::vector<bool> *wanted);
+request_table create_requests(obd2::obd2 &instance, obd2_server::vehicle &vehicle, bool decode);
+request_table build_requests(obd2::obd2 &instance, const obd2_server::vehicle &vehicle, bool decode, const std::vector<uint8_t> &supported_pids, const request_table *previous);
+log_schema describe_schema(const request_table &requests, const obd2_server::channel_graph &virtual_values);
+void watch_definition(obd2::obd2 &instance, const std::string &definition_file, const request_table &requests);
+std::unique_ptr<definition_reload> prepare_reload(obd2::obd2 &instance, const std::string &definition_file, const request_table &requests);
+void apply_reload(request_table &requests, obd2_server::vehicle &vehicle, uint64_t timestamp);
+void print_requests(request_table &requests);
+void adapt_refresh(obd2::obd2 &instance, request_table &requests);
+void apply_rules(request_table &requests, uint64_t timestamp, const std::vector<float> &data);
+void trace_refresh(request_table &requests, uint64_t dispatch_us);
+void print_request(const obd2_server::request &definition, const live_request &req, float val);
+void print_virtual_channel(const obd2_server::virtual_channel &channel, float val);
+void print_name(const std::string &name);
+void print_request_stats(const obd2_server::request_stats &stats);
+void write_request_stats(const request_table &requests);
 void clear_screen();
+std::vector<std::string> split_list(const std::string &list, char seperator);
+bool has_option(int argc, const char *argv[], int first, const std::string &name);
+std::string get_option(int argc, const char *argv[], int first, const std::string &name, const std::string &fallback);
 void sigint_handler(int sig);
 void error_invalid_arguments();
 void error_exit(const char *error_title, const char *error_desc);
 
+enum class capture_mode {
+    decoded,
+    raw,
+    both
+};
+
 const char ARG_SEPERATOR = ':';
+const char LIST_SEPERATOR = ',';
+const int LOG_OPTIONS_START = 5;
+const int QUERY_OPTIONS_START = 4;
+const size_t REDECODE_BLOCK_SAMPLES = 4096;
+const char *DEFAULT_LIVE_TABLE_NAME = "/obd2_live";
+const char *DEFAULT_SOCKET_PATH = "/tmp/obd2.sock";
+const uint32_t DEFAULT_ADAPTIVE_MIN_MS = 20;
+const uint32_t DEFAULT_ADAPTIVE_MAX_MS = 5000;
+const uint32_t TRACE_CYCLE_TRACK = std::numeric_limits<uint32_t>::max();
 std::string app_name;
 obd2_server::csv_logger logger;
+obd2_server::raw_log_writer raw_logger;
+obd2_server::live_table live_values;
+obd2_server::refresh_controller refresh_control;
+obd2_server::rollup rollups;
+obd2_server::channel_graph virtual_values;
+obd2_server::rule_engine rules;
+obd2_server::raw_log_writer triggered_capture;
+uint64_t capture_until = 0;
+// Indexed like the request table, boxed so statistics can follow their channel into a reloaded table
+std::vector<std::unique_ptr<obd2_server::request_stats>> request_statistics;
+bool collect_stats = false;
+// Categories to log, all if empty
+std::vector<std::string> logged_categories;
+// Compiles the formulas without a generated decoder to machine code, outlives every request table
+obd2_server::formula_jit jit;
+bool jit_enabled = false;
+capture_mode capture = capture_mode::decoded;
 std::atomic<bool> running = true;
+uint64_t trace_cycle_us = 0;
+uint64_t trace_poll_us = 0;
+// Handed to the refresh callback by setting reload_ready, after the swap it holds the replaced
+// tables until the watcher sees reload_ready cleared and frees them
+std::unique_ptr<definition_reload> pending_reload;
+std::atomic<bool> reload_ready = false;
 
 int main(int argc, const char *argv[]) {
     app_name = argv[0];
@@ -42,7 +234,30 @@ int main(int argc, const char *argv[]) {
         error_invalid_arguments();
     }
 
-    std::string command = argv[2];
+    std::string command = argv[1];
+
+    // Offline commands work on existing logs and need no network
+    if (command == "redecode") {
+        redecode_log(argc, argv);
+        return 0;
+    }
+    else if (command == "query") {
+        query_log(argc, argv);
+        return 0;
+    }
+    else if (command == "rollup") {
+        rollup_log(argc, argv);
+        return 0;
+    }
+
+    command = argv[2];
+
+    // A list of networks logs several buses into one timeline
+    if (command == "log" && std::strchr(argv[1], LIST_SEPERATOR) != nullptr) {
+        log_multi_bus(argc, argv);
+        return 0;
+    }
+
     obd2::obd2 obd_instance;
 
     try {
@@ -67,6 +282,9 @@ int main(int argc, const char *argv[]) {
     else if (command == "log") {
         log_requests(obd_instance, argc, argv);
     } 
+    else if (command == "serve") {
+        serve_requests(obd_instance, argc, argv);
+    }
     else {
         error_invalid_arguments();
     }
@@ -74,6 +292,295 @@ int main(int argc, const char *argv[]) {
     return 0;
 }
 
+void redecode_log(int argc, const char *argv[]) {
+    if (argc < 4) {
+        error_invalid_arguments();
+    }
+
+    obd2_server::raw_log_reader reader;
+    obd2_server::vehicle vehicle;
+
+    try {
+        reader = obd2_server::raw_log_reader(argv[2]);
+        vehicle = obd2_server::vehicle(argv[3]);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot open raw log", e.what());
+    }
+
+    std::vector<size_t> log_channels;
+    std::vector<obd2_server::formula> formulas;
+    std::vector<std::string> headers;
+    std::vector<int> precisions;
+
+    // Maps the channels of the current schema of the log to the definition
+    auto load_schema = [&]() {
+        const std::vector<std::string> &ids = reader.get_ids();
+
+        log_channels.clear();
+        formulas.clear();
+        headers.assign(1, "timestamp");
+        precisions.clear();
+
+        for (size_t i = 0; i < ids.size(); i++) {
+            try {
+                const obd2_server::request &req = vehicle.get_request(UUIDv4::UUID(ids[i]));
+
+                formulas.emplace_back(req.formula);
+                log_channels.push_back(i);
+                headers.emplace_back(req.name);
+                precisions.push_back(req.get_precision());
+            }
+            catch (std::invalid_argument &e) {
+                std::cerr << "Skipping channel " << UUIDv4::UUID(ids[i]) << ARG_SEPERATOR << " " << e.what() << std::endl;
+            }
+        }
+    };
+
+    load_schema();
+
+    obd2_server::csv_logger output;
+
+    try {
+        output = argc > 4 ? obd2_server::csv_logger(headers, argv[4]) : obd2_server::csv_logger(headers);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot create output log", e.what());
+    }
+
+    output.set_precisions(precisions);
+    output.set_autoflush(false);
+
+    obd2_server::raw_block block;
+    std::vector<std::vector<float>> decoded;
+    std::vector<const uint8_t *> columns;
+    std::vector<float> row;
+    size_t total = 0;
+    size_t schema_version = reader.get_schema_version();
+
+    // Decode whole columns per channel, then emit them row by row
+    while (size_t count = reader.read_block(block, REDECODE_BLOCK_SAMPLES)) {
+        // The logged channels changed, e.g. by a reloaded definition
+        if (reader.get_schema_version() != schema_version) {
+            schema_version = reader.get_schema_version();
+            load_schema();
+            output.write_schema(headers);
+            output.set_precisions(precisions);
+        }
+
+        decoded.resize(log_channels.size());
+        row.resize(log_channels.size());
+
+        for (size_t j = 0; j < log_channels.size(); j++) {
+            const obd2_server::raw_block::channel &channel = block.channels[log_channels[j]];
+
+            columns.clear();
+
+            for (const std::vector<uint8_t> &column : channel.columns) {
+                columns.push_back(column.data());
+            }
+
+            decoded[j].resize(count);
+            formulas[j].evaluate_columns(columns.data(), columns.size(), channel.lengths.data(), count, decoded[j].data());
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = 0; j < log_channels.size(); j++) {
+                row[j] = decoded[j][i];
+            }
+
+            output.write_row(block.timestamps[i], row);
+        }
+
+        total += count;
+    }
+
+    std::cout << "Decoded " << total << " samples of " << log_channels.size() << " channels" << std::endl;
+}
+
+void query_log(int argc, const char *argv[]) {
+    if (argc < 4) {
+        error_invalid_arguments();
+    }
+
+    obd2_server::csv_index index;
+    obd2_server::formula predicate;
+
+    try {
+        index = obd2_server::csv_index(argv[2]);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot index log", e.what());
+    }
+
+    try {
+        predicate = obd2_server::formula(argv[3]);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot parse query", e.what());
+    }
+
+    const std::vector<std::string> &columns = index.get_columns();
+    const std::vector<std::string> &variables = predicate.get_variables();
+    std::vector<size_t> variable_columns;
+
+    for (const std::string &name : variables) {
+        auto it = std::find(columns.begin(), columns.end(), name);
+
+        if (it == columns.end()) {
+            error_exit("Cannot parse query", ("Unknown channel " + name).c_str());
+        }
+
+        variable_columns.push_back(it - columns.begin());
+    }
+
+    if (predicate.get_required_bytes() != 0) {
+        error_exit("Cannot parse query", "Payload bytes are not logged, refer to channels as [name]");
+    }
+
+    size_t block_count = index.get_block_count();
+    obd2_server::csv_index::block block;
+    uint32_t from = 0;
+    uint32_t to = std::numeric_limits<uint32_t>::max();
+
+    // Times of day refer to the first day of the log unless they lie before its start
+    if (block_count != 0) {
+        index.read_block(0, block);
+
+        uint32_t start = block.first_time;
+        uint32_t from_time = 0;
+        uint32_t to_time = 0;
+        std::string from_string = get_option(argc, argv, QUERY_OPTIONS_START, "from", "");
+        std::string to_string = get_option(argc, argv, QUERY_OPTIONS_START, "to", "");
+
+        if (!from_string.empty()) {
+            if (!obd2_server::csv_index::parse_time(from_string.data(), from_string.data() + from_string.size(), from_time)) {
+                error_invalid_arguments();
+            }
+
+            from = from_time < start ? from_time + 86400 : from_time;
+        }
+
+        if (!to_string.empty()) {
+            if (!obd2_server::csv_index::parse_time(to_string.data(), to_string.data() + to_string.size(), to_time)) {
+                error_invalid_arguments();
+            }
+
+            to = to_time < start ? to_time + 86400 : to_time;
+        }
+    }
+
+    std::vector<obd2_server::formula::range> ranges(variables.size());
+    std::vector<float> values;
+    std::vector<float> arguments(variables.size());
+    std::string line;
+    uint32_t time;
+    size_t matches = 0;
+    size_t skipped = 0;
+
+    std::cout << "\"timestamp\"";
+
+    for (const std::string &name : columns) {
+        std::cout << ",\"" << name << "\"";
+    }
+
+    std::cout << '\n';
+
+    for (size_t i = index.find_block(from); i < block_count; i++) {
+        index.read_block(i, block);
+
+        if (block.first_time > to) {
+            break;
+        }
+
+        for (size_t j = 0; j < variables.size(); j++) {
+            ranges[j] = block.ranges[variable_columns[j]];
+        }
+
+        // Blocks whose bounds rule out a match are never read
+        obd2_server::formula::range result = predicate.evaluate_range(ranges.data());
+
+        if (result.min == 0 && result.max == 0) {
+            skipped++;
+            continue;
+        }
+
+        bool always = !result.maybe_nan && (result.min > 0 || result.max < 0);
+
+        index.seek(block);
+
+        while (index.next_row(line, time, values)) {
+            if (time < from || time > to) {
+                continue;
+            }
+
+            if (!always) {
+                for (size_t j = 0; j < variables.size(); j++) {
+                    arguments[j] = values[variable_columns[j]];
+                }
+
+                float value = predicate.evaluate(arguments.data());
+
+                if (!(value < 0 || value > 0)) {
+                    continue;
+                }
+            }
+
+            std::cout << line << '\n';
+            matches++;
+        }
+    }
+
+    std::cout.flush();
+    std::cerr << "Matched " << matches << " rows, skipped " << skipped << " of " << block_count << " blocks" << std::endl;
+}
+
+void rollup_log(int argc, const char *argv[]) {
+    if (argc < 3) {
+        error_invalid_arguments();
+    }
+
+    std::string log_name = argv[2];
+    std::string prefix = argc > 3 ? argv[3] : log_name.substr(0, log_name.rfind(".csv")) + "_rollup";
+    obd2_server::csv_index index;
+
+    try {
+        index = obd2_server::csv_index(log_name);
+        rollups = obd2_server::rollup(index.get_columns(), { }, prefix);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot roll up log", e.what());
+    }
+
+    // Logs only keep the time of day, anchor it to today's date
+    std::time_t now = std::time(nullptr);
+    std::tm midnight = *std::localtime(&now);
+    midnight.tm_hour = 0;
+    midnight.tm_min = 0;
+    midnight.tm_sec = 0;
+    midnight.tm_isdst = -1;
+    uint64_t base = static_cast<uint64_t>(std::mktime(&midnight));
+
+    obd2_server::csv_index::block block;
+    std::vector<float> values;
+    std::string line;
+    uint32_t time;
+    size_t rows = 0;
+
+    for (size_t i = 0; i < index.get_block_count(); i++) {
+        index.read_block(i, block);
+        index.seek(block);
+
+        while (index.next_row(line, time, values)) {
+            rollups.push((base + time) * 1000, values);
+            rows++;
+        }
+    }
+
+    rollups.finish();
+    std::cout << "Rolled up " << rows << " rows of " << index.get_columns().size() << " channels into " << prefix << "_*.csv" << std::endl;
+}
+
 void print_info(obd2::obd2 &instance) {
     std::cout << "Reading vehicle information..." << std::endl;
 
@@ -165,7 +672,7 @@ void log_requests(obd2::obd2 &instance, int argc, const char *argv[]) {
         error_invalid_arguments();
     }
 
-    std::map<const obd2_server::request *, obd2::request> requests;
+    request_table requests;
     obd2_server::vehicle vehicle;
     uint32_t refresh_ms = 1000;
 
@@ -182,121 +689,1142 @@ void log_requests(obd2::obd2 &instance, int argc, const char *argv[]) {
         refresh_ms = std::atoi(argv[4]);
     }
 
+    std::string capture_name = get_option(argc, argv, LOG_OPTIONS_START, "capture", "decoded");
+
+    if (capture_name == "raw") {
+        capture = capture_mode::raw;
+    }
+    else if (capture_name == "both") {
+        capture = capture_mode::both;
+    }
+    else if (capture_name != "decoded") {
+        error_invalid_arguments();
+    }
+
+    collect_stats = has_option(argc, argv, LOG_OPTIONS_START, "stats");
+    logged_categories = split_list(get_option(argc, argv, LOG_OPTIONS_START, "category", ""), LIST_SEPERATOR);
+    jit_enabled = has_option(argc, argv, LOG_OPTIONS_START, "jit");
+
+    if (jit_enabled && !obd2_server::formula_jit::available()) {
+        std::cerr << "The formula jit is not available on this platform, formulas are interpreted" << std::endl;
+        jit_enabled = false;
+    }
+
+    if (has_option(argc, argv, LOG_OPTIONS_START, "bitrate")) {
+#ifdef OBD2_PROFILE
+        obd2_server::profiler::get().set_bitrate(std::atoi(get_option(argc, argv, LOG_OPTIONS_START, "bitrate", "").c_str()));
+#else
+        std::cerr << "The bitrate option only takes effect with profiling compiled in (make PROFILE=1), ignoring it" << std::endl;
+#endif
+    }
+
+    if (has_option(argc, argv, LOG_OPTIONS_START, "adaptive")) {
+        std::vector<std::string> bounds = split_list(get_option(argc, argv, LOG_OPTIONS_START, "adaptive", ""), '-');
+        uint32_t min_ms = DEFAULT_ADAPTIVE_MIN_MS;
+        uint32_t max_ms = DEFAULT_ADAPTIVE_MAX_MS;
+
+        if (bounds.size() == 2) {
+            min_ms = std::atoi(bounds[0].c_str());
+            max_ms = std::atoi(bounds[1].c_str());
+        }
+        else if (!bounds.empty()) {
+            error_invalid_arguments();
+        }
+
+        std::string telemetry_file = "obd2_refresh_" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + ".csv";
+
+        try {
+            refresh_control = obd2_server::refresh_controller(min_ms, max_ms, refresh_ms, telemetry_file);
+        }
+        catch (std::exception &e) {
+            error_exit("Cannot enable adaptive refresh", e.what());
+        }
+
+        refresh_ms = refresh_control.get_refresh_ms();
+    }
+
     instance.set_refresh_ms(refresh_ms);
-    requests = create_requests(instance, vehicle);
+
+    // Raw only capture leaves decoding to redecode, so no formula runs while logging
+    requests = create_requests(instance, vehicle, capture != capture_mode::raw);
 
     if (requests.size() == 0) {
         error_exit("No requests to log", "No supported PIDs found");
     }
+
+    if (collect_stats) {
+        for (size_t i = 0; i < requests.size(); i++) {
+            request_statistics.push_back(std::make_unique<obd2_server::request_stats>());
+        }
+    }
     
-    std::vector<std::string> data_log_headers;
-    data_log_headers.reserve(requests.size() + 1);
-    data_log_headers.push_back("timestamp");
+    // Virtual channels derive from decoded values, which raw only capture does not have
+    if (capture != capture_mode::raw) {
+        try {
+            virtual_values = obd2_server::channel_graph(vehicle, requests.definitions);
+        }
+        catch (std::exception &e) {
+            error_exit("Cannot read vehicle definition", e.what());
+        }
+    }
+
+    log_schema schema = describe_schema(requests, virtual_values);
+
+    if (capture != capture_mode::raw) {
+        std::vector<std::string> rule_names(schema.headers.begin() + 1, schema.headers.end());
+
+        try {
+            rules = obd2_server::rule_engine(vehicle, rule_names, schema.live_ids);
+        }
+        catch (std::exception &e) {
+            error_exit("Cannot read vehicle definition", e.what());
+        }
+    }
+
+    try {
+        if (capture != capture_mode::raw) {
+            logger = obd2_server::csv_logger(schema.headers);
+            logger.set_precisions(schema.precisions);
+        }
+
+        if (capture != capture_mode::decoded) {
+            raw_logger = obd2_server::raw_log_writer(schema.raw_ids);
+        }
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot create log", e.what());
+    }
+
+    if (has_option(argc, argv, LOG_OPTIONS_START, "shm")) {
+        std::string shm_name = get_option(argc, argv, LOG_OPTIONS_START, "shm", DEFAULT_LIVE_TABLE_NAME);
 
-    for (const auto &p : requests) {
-        data_log_headers.push_back(p.first->name);
+        try {
+            live_values = obd2_server::live_table(shm_name, schema.live_ids);
+        }
+        catch (std::exception &e) {
+            error_exit("Cannot publish live values", e.what());
+        }
+    }
+
+    if (has_option(argc, argv, LOG_OPTIONS_START, "rollup")) {
+        if (capture == capture_mode::raw) {
+            error_exit("Cannot roll up", "Rollups need decoded values, use capture:both");
+        }
+
+        std::vector<std::string> names(schema.headers.begin() + 1, schema.headers.end());
+        std::string prefix = get_option(argc, argv, LOG_OPTIONS_START, "rollup", 
+            "obd2_rollup_" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+
+        try {
+            rollups = obd2_server::rollup(names, schema.precisions, prefix);
+        }
+        catch (std::exception &e) {
+            error_exit("Cannot roll up", e.what());
+        }
+    }
+
+    if (has_option(argc, argv, LOG_OPTIONS_START, "trace")) {
+        std::string trace_file = get_option(argc, argv, LOG_OPTIONS_START, "trace", 
+            "obd2_trace_" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + ".json");
+
+        try {
+            obd2_server::tracer::get().start(trace_file);
+        }
+        catch (std::exception &e) {
+            error_exit("Cannot start trace", e.what());
+        }
+    }
+
+    std::thread watcher;
+
+    if (has_option(argc, argv, LOG_OPTIONS_START, "reload")) {
+        // Both publish a fixed set of columns to readers that cannot follow a schema change
+        if (live_values.is_open() || rollups.is_open()) {
+            error_exit("Cannot reload definitions", "Reloading does not work together with shm or rollup");
+        }
+
+        watcher = std::thread(watch_definition, std::ref(instance), std::string(argv[3]), std::cref(requests));
     }
 
-    logger = obd2_server::csv_logger(data_log_headers);
     signal(SIGINT, sigint_handler);
-    instance.set_refreshed_cb(std::bind(print_requests, std::ref(requests)));
+    instance.set_refreshed_cb([&requests, &instance, &vehicle]() {
+        uint64_t dispatch_us = obd2_server::tracer::now_us();
+
+        if (reload_ready.load(std::memory_order_acquire)) {
+            apply_reload(requests, vehicle, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+
+        print_requests(requests);
+        adapt_refresh(instance, requests);
+
+        if (obd2_server::tracer::get().is_enabled()) {
+            trace_refresh(requests, dispatch_us);
+        }
+    });
 
     // Infinite loop to keep the program running
     while (running) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
-}
 
-std::map<const obd2_server::request *, obd2::request> create_requests(obd2::obd2 &instance, obd2_server::vehicle &vehicle) {
-    std::map<const obd2_server::request *, obd2::request> requests;
+    // The callback refers to requests, which go away with this scope
+    instance.set_refreshed_cb([]() noexcept { });
 
-    std::cout << "Fetching supported PIDs..." << std::endl;
+    if (watcher.joinable()) {
+        watcher.join();
+        // Its exchanges must go before the instance they are registered with
+        pending_reload.reset();
+    }
+    obd2_server::tracer::get().stop();
 
-    std::vector<uint8_t> pids = instance.get_supported_pids(0x7E0);
+    if (obd2_server::tracer::get().get_dropped() != 0) {
+        std::cerr << "Trace dropped " << obd2_server::tracer::get().get_dropped() << " events" << std::endl;
+    }
 
-    for (const obd2_server::request &req : vehicle.get_requests()) {
-        if (req.ecu == 0x7E0 && req.service == 0x01 && std::find(pids.begin(), pids.end(), req.pid) == pids.end()) {
-            continue;
-        }
+    if (rollups.is_open()) {
+        rollups.finish();
+    }
 
-        requests.try_emplace(&req, req.ecu, req.service, req.pid, instance, req.formula, true);
+    if (collect_stats) {
+        write_request_stats(requests);
     }
 
-    return requests;
+    OBD2_PROFILE_SUMMARY(std::cout);
 }
 
-void print_requests(std::map<const obd2_server::request *, obd2::request> &requests) {
-    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    std::vector<float> data;
-    data.reserve(requests.size());
-    
-    clear_screen();
-
-    for (auto &p : requests) {
-        float val = print_request(p);
-        data.push_back(val);
+void log_multi_bus(int argc, const char *argv[]) {
+    if (argc < 4) {
+        error_invalid_arguments();
     }
 
-    logger.write_row(data);
-}
-
-float print_request(std::pair<const obd2_server::request *const, obd2::request> &req) {
-    static uint8_t name_width = 0;
-    std::string name = req.first->name;
+    std::vector<std::string> networks = split_list(argv[1], LIST_SEPERATOR);
+    std::vector<std::string> definitions = split_list(argv[3], LIST_SEPERATOR);
+    uint32_t refresh_ms = 1000;
 
-    if (name.empty()) {
-        std::stringstream ss;
-        ss << std::hex << req.first->ecu << ARG_SEPERATOR << uint8_t(req.first->service) << ARG_SEPERATOR << req.first->pid;
-        name = ss.str();
+    if (networks.size() != definitions.size()) {
+        error_exit("Invalid Arguments", "Every network needs its own vehicle definition");
     }
 
-    name += ": ";
-
-    if (name.size() > name_width) {
-        name_width = name.size();
+    if (argc > 4) {
+        refresh_ms = std::atoi(argv[4]);
     }
 
-    std::cout << std::setw(name_width) << std::setfill(' ') << std::left << name << std::setw(0);
+    std::vector<std::unique_ptr<bus_session>> buses;
+    std::vector<std::future<request_table>> request_futures;
 
-    // Handle raw values
-    if (req.second.get_formula().empty()) {
-        const std::vector<uint8_t> &raw = req.second.get_raw();
+    std::cout << "Reading vehicle definitions..." << std::endl;
 
-        if (raw.size() == 0) {
-            std::cout << "No response" << std::endl;
-            return std::numeric_limits<float>::quiet_NaN();
+    for (size_t i = 0; i < networks.size(); i++) {
+        std::unique_ptr<bus_session> bus = std::make_unique<bus_session>();
+        bus->network = networks[i];
+        bus->index = i;
+
+        try {
+            bus->instance = obd2::obd2(networks[i].c_str());
+        }
+        catch (std::exception &e) {
+            error_exit(("Cannot create OBD2 instance for " + networks[i]).c_str(), e.what());
         }
 
-        for (uint8_t b : raw) {
-            std::cout << std::setfill('0') << std::setw(2) << std::hex << int(b) << " ";
+        try {
+            bus->vehicle = obd2_server::vehicle(definitions[i]);
+        }
+        catch (std::exception &e) {
+            error_exit(("Cannot read vehicle definition " + definitions[i]).c_str(), e.what());
         }
 
-        std::cout << std::dec << std::setw(0) << std::endl;
-        return std::numeric_limits<float>::quiet_NaN();
+        bus->instance.set_refresh_ms(refresh_ms);
+        buses.push_back(std::move(bus));
     }
 
-    float val = req.second.get_value();
-
-    if (std::isnan(val)) {
-        std::cout << "No response" << std::endl;
-        return std::numeric_limits<float>::quiet_NaN();
+    // Discover all buses at once instead of one after another
+    for (std::unique_ptr<bus_session> &bus : buses) {
+        request_futures.emplace_back(
+            std::async(
+                std::launch::async,
+                create_requests,
+                std::ref(bus->instance),
+                std::ref(bus->vehicle),
+                true
+            )
+        );
+    }
+
+    std::vector<std::string> data_log_headers;
+    std::vector<int> data_log_precisions;
+    data_log_headers.push_back("timestamp");
+
+    for (size_t i = 0; i < buses.size(); i++) {
+        bus_session &bus = *buses[i];
+        bus.requests = request_futures[i].get();
+        bus.column_offset = data_log_precisions.size();
+
+        if (bus.requests.size() == 0) {
+            error_exit(("No requests to log on " + bus.network).c_str(), "No supported PIDs found");
+        }
+
+        for (const obd2_server::request *definition : bus.requests.definitions) {
+            data_log_headers.push_back(bus.network + "/" + std::string(definition->name));
+            data_log_precisions.push_back(definition->get_precision());
+        }
+    }
+
+    try {
+        logger = obd2_server::csv_logger(data_log_headers);
+        logger.set_precisions(data_log_precisions);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot create log", e.what());
+    }
+
+    // Wait at most two refresh periods for a bus that lags behind
+    obd2_server::bus_merger merger(buses.size(), 2 * refresh_ms + 100);
+    obd2_server::bus_merger::sample sample;
+    std::vector<float> row(data_log_precisions.size());
+
+    auto write_merged = [&](uint64_t now) {
+        while (merger.pop(sample, now)) {
+            const bus_session &bus = *buses[sample.bus];
+
+            // Columns of the other buses have no value in this row
+            std::fill(row.begin(), row.end(), std::numeric_limits<float>::quiet_NaN());
+            std::copy(sample.values.begin(), sample.values.end(), row.begin() + bus.column_offset);
+            logger.write_row(sample.timestamp, row);
+        }
+    };
+
+    signal(SIGINT, sigint_handler);
+
+    for (std::unique_ptr<bus_session> &bus : buses) {
+        bus->instance.set_refreshed_cb(std::bind(collect_bus_sample, std::ref(*bus), std::ref(merger)));
+    }
+
+    std::cout << "Logging " << data_log_precisions.size() << " requests on " << buses.size() << " buses..." << std::endl;
+
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::max<uint32_t>(refresh_ms / 2, 10)));
+        write_merged(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    for (std::unique_ptr<bus_session> &bus : buses) {
+        bus->instance.set_refreshed_cb([]() noexcept { });
+    }
+
+    write_merged(std::numeric_limits<uint64_t>::max());
+
+    for (const std::unique_ptr<bus_session> &bus : buses) {
+        uint64_t duration_ms = bus->last_timestamp - bus->first_timestamp;
+        uint64_t samples = bus->responses + bus->timeouts;
+
+        std::cout << bus->network << ARG_SEPERATOR << " " << bus->cycles << " cycles, "
+            << bus->responses << " responses, " << bus->timeouts << " timeouts";
+
+        if (samples > 0) {
+            std::cout << " (" << std::fixed << std::setprecision(1) << 100.0 * bus->responses / samples << "% answered)";
+        }
+
+        if (bus->cycles > 1) {
+            std::cout << ", " << std::setprecision(1) << double(duration_ms) / (bus->cycles - 1) << " ms per cycle";
+        }
+
+        std::cout << std::defaultfloat << std::endl;
+    }
+}
+
+void collect_bus_sample(bus_session &bus, obd2_server::bus_merger &merger) {
+    // Runs on the bus' acquisition thread, give every bus a core of its own
+    if (!bus.pinned) {
+        unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        CPU_SET(bus.index % cores, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        bus.pinned = true;
+    }
+
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<float> values(bus.requests.size());
+
+    // Per bus request, channels sharing a PID were answered by the same response
+    for (const std::shared_ptr<bus_exchange> &e : bus.requests.exchanges) {
+        if (e->request.get_raw().empty()) {
+            bus.timeouts++;
+        }
+        else {
+            bus.responses++;
+        }
+    }
+
+    decode_requests(bus.requests, values.data(), nullptr);
+
+    if (bus.cycles == 0) {
+        bus.first_timestamp = timestamp;
+    }
+
+    bus.cycles++;
+    bus.last_timestamp = timestamp;
+    merger.push(bus.index, timestamp, std::move(values));
+}
+
+void serve_requests(obd2::obd2 &instance, int argc, const char *argv[]) {
+    if (argc < 4) {
+        error_invalid_arguments();
+    }
+
+    request_table requests;
+    obd2_server::vehicle vehicle;
+    uint32_t refresh_ms = 1000;
+
+    std::cout << "Reading vehicle definition..." << std::endl;
+
+    try {
+        vehicle = obd2_server::vehicle(argv[3]);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot read vehicle definition", e.what());
+    }
+
+    if (argc > 4) {
+        refresh_ms = std::atoi(argv[4]);
+    }
+
+    instance.set_refresh_ms(refresh_ms);
+    requests = create_requests(instance, vehicle, true);
+
+    if (requests.size() == 0) {
+        error_exit("No requests to serve", "No supported PIDs found");
+    }
+
+    std::vector<std::string> ids;
+    ids.reserve(requests.size());
+
+    for (const obd2_server::request *definition : requests.definitions) {
+        ids.push_back(definition->id.bytes());
+    }
+
+    std::string socket_path = get_option(argc, argv, LOG_OPTIONS_START, "socket", DEFAULT_SOCKET_PATH);
+    std::unique_ptr<obd2_server::stream_server> server;
+
+    try {
+        server = std::make_unique<obd2_server::stream_server>(socket_path, ids);
+    }
+    catch (std::exception &e) {
+        error_exit("Cannot start server", e.what());
+    }
+
+    std::cout << "Serving " << requests.size() << " requests on " << socket_path << std::endl;
+
+    signal(SIGINT, sigint_handler);
+    instance.set_refreshed_cb(std::bind(publish_requests, std::ref(requests), std::ref(*server)));
+
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    // The server goes away with this scope, so stop feeding it first
+    instance.set_refreshed_cb([]() noexcept { });
+}
+
+void publish_requests(request_table &requests, obd2_server::stream_server &server) {
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<float> values(requests.size());
+    std::vector<bool> wanted(requests.size());
+
+    // Only the channels some client subscribed to are ever sent
+    for (size_t i = 0; i < requests.size(); i++) {
+        wanted[i] = server.is_subscribed(i);
+    }
+
+    decode_requests(requests, values.data(), &wanted);
+    server.publish(timestamp, values);
+}
+
+// Decodes the channels of a sample into out, only those set in wanted unless it is null. The others are NaN.
+// Sinks read the decoded sample from out, so every channel is decoded at most once per sample.
+void decode_requests(request_table &requests, float *out, const std::vector<bool> *wanted) {
+    bool any_affine = false;
+
+    for (size_t lane = 0; lane < requests.affine_channels.size(); lane++) {
+        uint32_t i = requests.affine_channels[lane];
+
+        if (wanted != nullptr && !(*wanted)[i]) {
+            requests.affine_payloads[lane] = nullptr;
+            continue;
+        }
+
+        requests.affine_payloads[lane] = &requests[i].get_raw();
+        any_affine = true;
+    }
+
+    if (any_affine) {
+        const float *values = requests.affine.evaluate(requests.affine_payloads.data());
+
+        for (size_t lane = 0; lane < requests.affine_channels.size(); lane++) {
+            out[requests.affine_channels[lane]] = values[lane];
+        }
+    }
+    else {
+        for (uint32_t i : requests.affine_channels) {
+            out[i] = std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+
+    for (const standard_channel &c : requests.standard_channels) {
+        if (wanted != nullptr && !(*wanted)[c.index]) {
+            out[c.index] = std::numeric_limits<float>::quiet_NaN();
+            continue;
+        }
+
+        const std::vector<uint8_t> &raw = requests[c.index].get_raw();
+        out[c.index] = obd2_server::standard_decoders::decode(c.pid, c.channel, raw.data(), raw.size());
+    }
+
+    for (uint32_t i : requests.general_channels) {
+        out[i] = wanted == nullptr || (*wanted)[i] ? requests[i].get_value() : std::numeric_limits<float>::quiet_NaN();
+    }
+}
+
+request_table create_requests(obd2::obd2 &instance, obd2_server::vehicle &vehicle, bool decode) {
+    std::cout << "Fetching supported PIDs..." << std::endl;
+
+    std::vector<uint8_t> pids = instance.get_supported_pids(0x7E0);
+    request_table requests;
+
+    try {
+        requests = build_requests(instance, vehicle, decode, pids, nullptr);
+    }
+    catch (std::invalid_argument &e) {
+        error_exit("Cannot read vehicle definition", e.what());
+    }
+
+    return requests;
+}
+
+// Exchanges of previous with the same (ecu, service, pid) are taken over instead of created anew
+request_table build_requests(obd2::obd2 &instance, const obd2_server::vehicle &vehicle, bool decode, const std::vector<uint8_t> &supported_pids, const request_table *previous) {
+    request_table requests;
+    std::unordered_map<uint64_t, std::shared_ptr<bus_exchange>> exchanges;
+    std::unordered_map<std::string_view, const obd2_server::formula *> decoders;
+    std::vector<obd2_server::formula *> interpreted;
+    requests.decoders.reserve(vehicle.get_requests().size());
+    requests.channels.reserve(vehicle.get_requests().size());
+    requests.definitions.reserve(vehicle.get_requests().size());
+    requests.supported_pids = supported_pids;
+
+    std::vector<bool> selected(vehicle.get_categories().size(), logged_categories.empty());
+
+    for (const std::string &category : logged_categories) {
+        uint32_t id = vehicle.find_category(category);
+
+        if (id == obd2_server::vehicle::NO_CATEGORY) {
+            throw std::invalid_argument("Unknown category " + category);
+        }
+
+        selected[id] = true;
+    }
+
+    std::unordered_map<uint64_t, std::shared_ptr<bus_exchange>> reusable;
+
+    if (previous != nullptr) {
+        for (const std::shared_ptr<bus_exchange> &e : previous->exchanges) {
+            reusable.emplace(uint64_t(e->ecu) << 24 | uint64_t(e->service) << 16 | e->pid, e);
+        }
+    }
+
+    for (const obd2_server::request &req : vehicle.get_requests()) {
+        if (!selected[req.category_id]) {
+            continue;
+        }
+
+        if (req.ecu == 0x7E0 && req.service == 0x01 && std::find(supported_pids.begin(), supported_pids.end(), req.pid) == supported_pids.end()) {
+            continue;
+        }
+
+        // Channels splitting one PID into several values share its bus request
+        uint64_t key = uint64_t(req.ecu) << 24 | uint64_t(req.service) << 16 | req.pid;
+        auto it = exchanges.find(key);
+
+        if (it == exchanges.end()) {
+            auto r = reusable.find(key);
+            std::shared_ptr<bus_exchange> exchange = r != reusable.end() ? r->second : std::make_shared<bus_exchange>(req, instance);
+
+            it = exchanges.emplace(key, exchange).first;
+            requests.exchanges.push_back(exchange);
+        }
+
+        const obd2_server::formula *decoder = nullptr;
+        size_t generated_channel = SIZE_MAX;
+
+        if (decode && !req.formula.empty()) {
+            if (req.service == 0x01 && req.pid <= 0xFF) {
+                generated_channel = obd2_server::standard_decoders::find_channel(req.pid, req.formula);
+            }
+
+            auto d = decoders.find(req.formula);
+
+            if (d == decoders.end()) {
+                // Snapshots decode affine formulas in the SIMD batch below and the other standard Service 01
+                // formulas through standard_decoders::decode. formula::evaluate runs standard formulas as
+                // generated code too, the rest on the jit if enabled, else on the formula engine.
+                obd2_server::formula::native_decoder native = req.service == 0x01 && req.pid <= 0xFF
+                    ? obd2_server::standard_decoders::find(req.pid, req.formula)
+                    : nullptr;
+
+                d = decoders.emplace(req.formula, &requests.decoders.emplace_back(req.formula, native)).first;
+
+                if (native == nullptr && !requests.decoders.back().is_affine()) {
+                    interpreted.push_back(&requests.decoders.back());
+                }
+            }
+
+            decoder = d->second;
+        }
+
+        if (decoder != nullptr && decoder->is_affine()) {
+            requests.affine.add(*decoder);
+            requests.affine_channels.push_back(uint32_t(requests.channels.size()));
+            requests.affine_payloads.push_back(nullptr);
+        }
+        else if (generated_channel != SIZE_MAX) {
+            requests.standard_channels.push_back({ uint32_t(requests.channels.size()), uint8_t(req.pid), uint8_t(generated_channel) });
+        }
+        else {
+            requests.general_channels.push_back(uint32_t(requests.channels.size()));
+        }
+
+        requests.channels.push_back({ &it->second->request, decoder });
+        requests.definitions.push_back(&req);
+    }
+
+    if (jit_enabled) {
+        std::vector<const obd2_server::formula *> compiled(interpreted.begin(), interpreted.end());
+        std::vector<obd2_server::formula::native_decoder> natives = jit.compile(compiled);
+
+        // Unsupported formulas get nullptr and stay interpreted
+        for (size_t i = 0; i < interpreted.size(); i++) {
+            interpreted[i]->set_native(natives[i]);
+        }
+    }
+
+    return requests;
+}
+
+log_schema describe_schema(const request_table &requests, const obd2_server::channel_graph &virtual_values) {
+    log_schema schema;
+    schema.headers.reserve(requests.size() + virtual_values.get_channels().size() + 1);
+    schema.precisions.reserve(requests.size() + virtual_values.get_channels().size());
+    schema.raw_ids.reserve(requests.size());
+    schema.headers.push_back("timestamp");
+
+    for (const obd2_server::request *definition : requests.definitions) {
+        schema.headers.emplace_back(definition->name);
+        schema.precisions.push_back(definition->get_precision());
+        schema.raw_ids.push_back(definition->id.bytes());
+    }
+
+    schema.live_ids = schema.raw_ids;
+
+    for (const obd2_server::virtual_channel *c : virtual_values.get_channels()) {
+        schema.headers.push_back(c->name);
+        schema.precisions.push_back(c->get_precision());
+        schema.live_ids.push_back(c->id.bytes());
+    }
+
+    return schema;
+}
+
+// Runs on its own thread. requests is only read while no reload is pending, since the
+// refresh callback swaps its contents then.
+void watch_definition(obd2::obd2 &instance, const std::string &definition_file, const request_table &requests) {
+    std::unique_ptr<obd2_server::file_watcher> watcher;
+
+    try {
+        watcher = std::make_unique<obd2_server::file_watcher>(definition_file);
+    }
+    catch (std::exception &e) {
+        std::cerr << "Cannot watch vehicle definition" << ARG_SEPERATOR << " " << e.what() << std::endl;
+        return;
+    }
+
+    while (running) {
+        if (!watcher->wait(1000)) {
+            continue;
+        }
+
+        // One reload at a time, the previous one may still wait for the next cycle
+        while (running && reload_ready.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        if (!running) {
+            break;
+        }
+
+        // The replaced tables of the previous reload, exchanges not shared anymore stop polling here
+        pending_reload.reset();
+        pending_reload = prepare_reload(instance, definition_file, requests);
+
+        if (pending_reload != nullptr) {
+            reload_ready.store(true, std::memory_order_release);
+        }
+    }
+}
+
+std::unique_ptr<definition_reload> prepare_reload(obd2::obd2 &instance, const std::string &definition_file, const request_table &requests) {
+    std::unique_ptr<definition_reload> reload = std::make_unique<definition_reload>();
+
+    // A broken definition keeps the running one, the file may still be in the middle of an edit
+    try {
+        reload->vehicle = obd2_server::vehicle(definition_file);
+        reload->requests = build_requests(instance, reload->vehicle, capture != capture_mode::raw, requests.supported_pids, &requests);
+
+        if (capture != capture_mode::raw) {
+            reload->virtual_values = obd2_server::channel_graph(reload->vehicle, reload->requests.definitions);
+        }
+
+        reload->schema = describe_schema(reload->requests, reload->virtual_values);
+
+        if (capture != capture_mode::raw) {
+            std::vector<std::string> rule_names(reload->schema.headers.begin() + 1, reload->schema.headers.end());
+            reload->rules = obd2_server::rule_engine(reload->vehicle, rule_names, reload->schema.live_ids);
+        }
+    }
+    catch (std::exception &e) {
+        std::cerr << "Ignoring changed vehicle definition" << ARG_SEPERATOR << " " << e.what() << std::endl;
+        return nullptr;
+    }
+
+    obd2_server::uuid_table old_ids;
+    size_t added = 0;
+    size_t changed = 0;
+
+    for (const obd2_server::request *definition : requests.definitions) {
+        old_ids.push_back(definition->id);
+    }
+
+    for (const obd2_server::request *definition : reload->requests.definitions) {
+        size_t index = old_ids.find(definition->id);
+
+        if (index == obd2_server::uuid_table::NPOS) {
+            added++;
+        }
+        else {
+            const obd2_server::request *old = requests.definitions[index];
+
+            if (old->ecu != definition->ecu || old->service != definition->service || old->pid != definition->pid || old->formula != definition->formula) {
+                index = obd2_server::uuid_table::NPOS;
+                changed++;
+            }
+        }
+
+        reload->previous.push_back(index);
+    }
+
+    size_t removed = requests.size() - (reload->requests.size() - added);
+
+    reload->summary = "definition reloaded: " + std::to_string(added) + " added, " 
+        + std::to_string(removed) + " removed, " + std::to_string(changed) + " changed";
+
+    return reload;
+}
+
+// Called by the refresh callback between two cycles, so nothing samples while the tables change
+void apply_reload(request_table &requests, obd2_server::vehicle &vehicle, uint64_t timestamp) {
+    definition_reload &reload = *pending_reload;
+
+    // Statistics carry over for channels that still decode the same request
+    if (collect_stats) {
+        std::vector<std::unique_ptr<obd2_server::request_stats>> statistics;
+
+        for (size_t previous : reload.previous) {
+            statistics.push_back(previous != obd2_server::uuid_table::NPOS 
+                ? std::move(request_statistics[previous]) : std::make_unique<obd2_server::request_stats>());
+        }
+
+        request_statistics = std::move(statistics);
+    }
+
+    std::swap(requests, reload.requests);
+    std::swap(vehicle, reload.vehicle);
+    std::swap(virtual_values, reload.virtual_values);
+    std::swap(rules, reload.rules);
+
+    if (capture != capture_mode::raw) {
+        logger.write_marker(timestamp, reload.summary);
+        logger.write_schema(reload.schema.headers);
+        logger.set_precisions(reload.schema.precisions);
+    }
+
+    if (capture != capture_mode::decoded) {
+        raw_logger.write_schema(reload.schema.raw_ids);
+    }
+
+    if (capture_until != 0) {
+        triggered_capture.write_schema(reload.schema.raw_ids);
+    }
+
+    reload_ready.store(false, std::memory_order_release);
+}
+
+void print_requests(request_table &requests) {
+    OBD2_PROFILE_CYCLE_BEGIN();
+
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<float> data;
+    data.reserve(requests.size() + virtual_values.get_channels().size());
+
+    {
+        OBD2_PROFILE_SCOPE(decoding);
+        obd2_server::trace_scope trace("decode");
+
+        data.resize(requests.size());
+        decode_requests(requests, data.data(), nullptr);
+
+        if (collect_stats) {
+            for (size_t i = 0; i < requests.size(); i++) {
+                request_statistics[i]->record(timestamp, requests[i].get_raw());
+            }
+        }
+
+        for (const std::shared_ptr<bus_exchange> &e : requests.exchanges) {
+            OBD2_PROFILE_EXCHANGE(e->service, e->request.get_raw().size());
+        }
+
+        if (!virtual_values.empty()) {
+            data.resize(requests.size() + virtual_values.get_channels().size());
+            virtual_values.evaluate(timestamp, data.data(), data.data() + requests.size());
+        }
+    }
+
+    {
+        OBD2_PROFILE_SCOPE(displaying);
+        obd2_server::trace_scope trace("display");
+        
+        clear_screen();
+        OBD2_PROFILE_REPORT(std::cout);
+
+        if (refresh_control.is_enabled()) {
+            std::cout << "Refresh: " << refresh_control.get_refresh_ms() << " ms (" << refresh_control.get_reason() << ")" << std::endl;
+        }
+
+        size_t i = 0;
+
+        for (; i < requests.size(); i++) {
+            print_request(*requests.definitions[i], requests[i], data[i]);
+
+            if (collect_stats) {
+                print_request_stats(*request_statistics[i]);
+            }
+
+            std::cout << std::endl;
+        }
+
+        for (const obd2_server::virtual_channel *c : virtual_values.get_channels()) {
+            print_virtual_channel(*c, data[i++]);
+            std::cout << std::endl;
+        }
+    }
+
+    {
+        OBD2_PROFILE_SCOPE(logging);
+        obd2_server::trace_scope trace("log");
+
+        if (live_values.is_open()) {
+            size_t i = 0;
+
+            live_values.begin_update();
+
+            for (auto &p : requests) {
+                obd2_server::live_status status = obd2_server::live_status::ok;
+
+                if (p.get_raw().empty()) {
+                    status = obd2_server::live_status::no_response;
+                }
+                else if (p.decoder == nullptr) {
+                    status = obd2_server::live_status::raw_only;
+                }
+
+                live_values.set(i, data[i], timestamp, status);
+                i++;
+            }
+
+            for (; i < data.size(); i++) {
+                live_values.set(i, data[i], timestamp, std::isnan(data[i]) ? obd2_server::live_status::no_response : obd2_server::live_status::ok);
+            }
+
+            live_values.end_update();
+        }
+
+        if (capture != capture_mode::raw) {
+            logger.write_row(timestamp, data);
+        }
+
+        if (rollups.is_open()) {
+            rollups.push(timestamp, data);
+        }
+
+        if (!rules.empty()) {
+            apply_rules(requests, timestamp, data);
+        }
+
+        if (capture != capture_mode::decoded) {
+            raw_logger.begin_sample(timestamp);
+
+            for (auto &p : requests) {
+                raw_logger.write_payload(p.get_raw());
+            }
+
+            raw_logger.end_sample();
+        }
+    }
+
+    OBD2_PROFILE_CYCLE_END();
+}
+
+void apply_rules(request_table &requests, uint64_t timestamp, const std::vector<float> &data) {
+    for (const obd2_server::rule *r : rules.update(timestamp, data.data())) {
+        switch (r->action) {
+            case obd2_server::rule_action::marker:
+                logger.write_marker(timestamp, "rule " + r->name);
+                break;
+            case obd2_server::rule_action::message:
+                std::cerr << timestamp << " rule " << r->name << " fired" << std::endl;
+                break;
+            case obd2_server::rule_action::capture:
+                if (capture_until == 0) {
+                    std::vector<std::string> ids;
+
+                    for (const obd2_server::request *definition : requests.definitions) {
+                        ids.push_back(definition->id.bytes());
+                    }
+
+                    try {
+                        triggered_capture = obd2_server::raw_log_writer(ids, "obd2_capture_" + std::to_string(timestamp / 1000) + ".bin");
+                    }
+                    catch (std::exception &e) {
+                        std::cerr << "Cannot start capture for rule " << r->name << ARG_SEPERATOR << " " << e.what() << std::endl;
+                        break;
+                    }
+                }
+
+                // Overlapping triggers extend the running capture
+                capture_until = std::max(capture_until, timestamp + r->capture_ms);
+                break;
+        }
+    }
+
+    if (capture_until == 0) {
+        return;
+    }
+
+    triggered_capture.begin_sample(timestamp);
+
+    for (auto &p : requests) {
+        triggered_capture.write_payload(p.get_raw());
+    }
+
+    triggered_capture.end_sample();
+
+    if (timestamp >= capture_until) {
+        triggered_capture = obd2_server::raw_log_writer();
+        capture_until = 0;
+    }
+}
+
+// The library only reports finished cycles, so round trips are spanned from the end of the
+// previous callback, when polling resumed, to the dispatch that delivered the response
+void trace_refresh(request_table &requests, uint64_t dispatch_us) {
+    obd2_server::tracer &trace = obd2_server::tracer::get();
+    uint64_t now_us = obd2_server::tracer::now_us();
+
+    if (trace_cycle_us != 0) {
+        trace.record("refresh cycle", trace_cycle_us, dispatch_us, TRACE_CYCLE_TRACK);
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            if (!requests[i].get_raw().empty()) {
+                const obd2_server::request *definition = requests.definitions[i];
+                trace.record(definition->name.data(), trace_poll_us, dispatch_us, definition->ecu);
+            }
+        }
+    }
+
+    trace.record("callback dispatch", dispatch_us, now_us);
+    trace_cycle_us = dispatch_us;
+    trace_poll_us = now_us;
+}
+
+void adapt_refresh(obd2::obd2 &instance, request_table &requests) {
+    if (!refresh_control.is_enabled()) {
+        return;
+    }
+
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<obd2_server::refresh_controller::ecu_sample> ecus;
+
+    for (const std::shared_ptr<bus_exchange> &exchange : requests.exchanges) {
+        auto it = std::find_if(ecus.begin(), ecus.end(), [&](const auto &e) { return e.ecu == exchange->ecu; });
+
+        if (it == ecus.end()) {
+            ecus.push_back({ exchange->ecu, 0, 0 });
+            it = ecus.end() - 1;
+        }
+
+        it->requests++;
+
+        if (!exchange->request.get_raw().empty()) {
+            it->responses++;
+        }
+    }
+
+    if (refresh_control.update(timestamp, ecus)) {
+        instance.set_refresh_ms(refresh_control.get_refresh_ms());
+    }
+}
+
+void print_request(const obd2_server::request &definition, const live_request &req, float val) {
+    std::string name(definition.name);
+
+    if (name.empty()) {
+        std::stringstream ss;
+        ss << std::hex << definition.ecu << ARG_SEPERATOR << uint8_t(definition.service) << ARG_SEPERATOR << definition.pid;
+        name = ss.str();
+    }
+
+    print_name(name);
+
+    // Handle raw values
+    if (req.decoder == nullptr) {
+        const std::vector<uint8_t> &raw = req.get_raw();
+
+        if (raw.size() == 0) {
+            std::cout << "No response";
+            return;
+        }
+
+        for (uint8_t b : raw) {
+            std::cout << std::setfill('0') << std::setw(2) << std::hex << int(b) << " ";
+        }
+
+        std::cout << std::dec << std::setw(0);
+        return;
+    }
+
+    if (std::isnan(val)) {
+        std::cout << "No response";
+        return;
     }
     
-    std::cout << val << req.first->unit << std::endl;
-    return val;
+    std::cout << val << definition.unit;
+}
+
+void print_virtual_channel(const obd2_server::virtual_channel &channel, float val) {
+    print_name(channel.name);
+
+    if (std::isnan(val)) {
+        std::cout << "No value";
+        return;
+    }
+
+    std::cout << val << channel.unit;
+}
+
+void print_name(const std::string &name) {
+    // Align values across calls
+    static uint8_t name_width = 0;
+    std::string label = name + ": ";
+
+    if (label.size() > name_width) {
+        name_width = label.size();
+    }
+
+    std::cout << std::setw(name_width) << std::setfill(' ') << std::left << label << std::setw(0);
+}
+
+void print_request_stats(const obd2_server::request_stats &stats) {
+    const obd2_server::latency_histogram &latency = stats.get_latency_us();
+    std::streamsize precision = std::cout.precision();
+
+    std::cout << "\t[" << stats.get_successes() << " ok, " << stats.get_timeouts() << " timeouts, " 
+        << stats.get_negative_responses() << " negative, " << std::fixed << std::setprecision(1) 
+        << stats.get_sample_rate() << " Hz, p50 " << latency.get_percentile(50) / 1000.0 
+        << " ms, p99 " << latency.get_percentile(99) / 1000.0 << " ms]" << std::defaultfloat << std::setprecision(precision);
+}
+
+void write_request_stats(const request_table &requests) {
+    std::string filename = "obd2_stats_" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + ".json";
+    std::ofstream file(filename);
+    nlohmann::json j = nlohmann::json::array();
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        nlohmann::json entry = *request_statistics[i];
+        entry["id"] = requests.definitions[i]->id.str();
+        entry["name"] = requests.definitions[i]->name;
+        j.push_back(entry);
+    }
+
+    file << j.dump(4) << std::endl;
+
+    if (!file) {
+        std::cerr << app_name << ARG_SEPERATOR << " Cannot write " << filename << std::endl;
+    }
 }
 
 void clear_screen() {
     std::cout << "\033[2J\033[1;1H";
 }
 
+std::vector<std::string> split_list(const std::string &list, char seperator) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+
+    while (std::getline(ss, item, seperator)) {
+        items.push_back(item);
+    }
+
+    return items;
+}
+
+bool has_option(int argc, const char *argv[], int first, const std::string &name) {
+    for (int i = first; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == name || (arg.size() > name.size() && arg.compare(0, name.size(), name) == 0 && arg[name.size()] == ARG_SEPERATOR)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::string get_option(int argc, const char *argv[], int first, const std::string &name, const std::string &fallback) {
+    // Options follow the positional arguments as name or name:value
+    for (int i = first; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.size() > name.size() && arg.compare(0, name.size(), name) == 0 && arg[name.size()] == ARG_SEPERATOR) {
+            return arg.substr(name.size() + 1);
+        }
+    }
+
+    return fallback;
+}
+
 void sigint_handler(int sig) {
     running = false;
 }
 
 void error_invalid_arguments() {
-    std::string desc = "\nUsage: " + app_name + " network command\n\n" 
-        + "commands: log, info, dtc_list, dtc_clear, pids";
+    std::string desc = "\nUsage: " + app_name + " network command\n"
+        + "       " + app_name + " network log definition [refresh_ms] [options]\n"
+        + "       " + app_name + " network,network,... log definition,definition,... [refresh_ms]\n"
+        + "       " + app_name + " network serve definition [refresh_ms] [socket" + ARG_SEPERATOR + "path]\n"
+        + "       " + app_name + " redecode raw_log definition [output]\n"
+        + "       " + app_name + " query csv_log predicate [from" + ARG_SEPERATOR + "HH:MM:SS] [to" + ARG_SEPERATOR + "HH:MM:SS]\n"
+        + "       " + app_name + " rollup csv_log [output_prefix]\n\n" 
+        + "commands: log, serve, info, dtc_list, dtc_clear, pids\n"
+        + "log options: capture" + ARG_SEPERATOR + "decoded|raw|both, shm[" + ARG_SEPERATOR + "name], adaptive[" + ARG_SEPERATOR + "min_ms-max_ms], stats, bitrate" + ARG_SEPERATOR + "bits_per_s, trace[" + ARG_SEPERATOR + "file], rollup[" + ARG_SEPERATOR + "prefix], category" + ARG_SEPERATOR + "name,name,..., reload, jit";
     error_exit("Invalid Arguments", desc.c_str());
 }
 
@@ -0,0 +1,113 @@
+#include "profiler.h"
+
+#include <iomanip>
+
+namespace obd2_server {
+    static constexpr std::array<const char *, size_t(profile_phase::count)> PHASE_NAMES = {
+        "waiting", "decoding", "displaying", "logging"
+    };
+
+    profiler::profiler() : window_start(std::chrono::steady_clock::now()), last_cycle_end(window_start) { }
+
+    profiler &profiler::get() {
+        static profiler instance;
+        return instance;
+    }
+
+    void profiler::set_bitrate(uint32_t bitrate) {
+        this->bitrate = bitrate;
+    }
+
+    void profiler::add(profile_phase phase, uint64_t ns) {
+        phase_ns[size_t(phase)].fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void profiler::begin_cycle() {
+        auto now = std::chrono::steady_clock::now();
+        add(profile_phase::waiting, std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_cycle_end).count());
+    }
+
+    void profiler::end_cycle() {
+        last_cycle_end = std::chrono::steady_clock::now();
+        cycles.fetch_add(1, std::memory_order_relaxed);
+
+        if (last_cycle_end - window_start < REPORT_WINDOW) {
+            return;
+        }
+
+        report r;
+        r.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(last_cycle_end - window_start).count();
+        r.cycles = cycles.exchange(0, std::memory_order_relaxed);
+        r.frames = frames.exchange(0, std::memory_order_relaxed);
+        r.bits = r.frames * BITS_PER_FRAME;
+
+        for (size_t i = 0; i < r.phase_ns.size(); i++) {
+            r.phase_ns[i] = phase_ns[i].exchange(0, std::memory_order_relaxed);
+            total.phase_ns[i] += r.phase_ns[i];
+        }
+
+        total.duration_ns += r.duration_ns;
+        total.cycles += r.cycles;
+        total.frames += r.frames;
+        total.bits += r.bits;
+
+        last_report = r;
+        window_start = last_cycle_end;
+    }
+
+    void profiler::record_exchange(uint8_t service, size_t payload_size) {
+        // The request always fits a single frame
+        uint64_t count = 1;
+
+        if (payload_size > 0) {
+            // Positive response echoes the service and the PID (one byte) or DID (two bytes)
+            size_t response_size = payload_size + (service == 0x01 ? 2 : 3);
+
+            if (response_size <= SINGLE_FRAME_BYTES) {
+                count += 1;
+            }
+            else {
+                // First frame, our flow control frame and the consecutive frames
+                count += 2 + (response_size - FIRST_FRAME_BYTES + CONSECUTIVE_FRAME_BYTES - 1) / CONSECUTIVE_FRAME_BYTES;
+            }
+        }
+
+        frames.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    const profiler::report &profiler::get_last_report() const {
+        return last_report;
+    }
+
+    const profiler::report &profiler::get_total() const {
+        return total;
+    }
+
+    void profiler::print(std::ostream &os) const {
+        print(os, last_report);
+    }
+
+    void profiler::print(std::ostream &os, const report &r) const {
+        if (r.duration_ns == 0) {
+            return;
+        }
+
+        double seconds = r.duration_ns / 1e9;
+        std::streamsize precision = os.precision();
+
+        os << std::fixed << std::setprecision(1) << "Bus: " << r.frames / seconds << " frames/s, " 
+            << 100.0 * r.bits / (bitrate * seconds) << "% of " << bitrate / 1000 << " kbit/s | ";
+
+        for (size_t i = 0; i < r.phase_ns.size(); i++) {
+            os << PHASE_NAMES[i] << " " << 100.0 * r.phase_ns[i] / r.duration_ns << "%" << (i + 1 < r.phase_ns.size() ? ", " : "");
+        }
+
+        os << " | " << r.cycles / seconds << " cycles/s" << std::defaultfloat << std::setprecision(precision) << std::endl;
+    }
+
+    profile_scope::profile_scope(profile_phase phase) : phase(phase), start(std::chrono::steady_clock::now()) { }
+
+    profile_scope::~profile_scope() {
+        profiler::get().add(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+}
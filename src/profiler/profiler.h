@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Profiling hooks are only compiled in with OBD2_PROFILE defined (make PROFILE=1)
+#ifdef OBD2_PROFILE
+#define OBD2_PROFILE_CONCAT_INNER(a, b) a##b
+#define OBD2_PROFILE_CONCAT(a, b) OBD2_PROFILE_CONCAT_INNER(a, b)
+#define OBD2_PROFILE_SCOPE(phase) obd2_server::profile_scope OBD2_PROFILE_CONCAT(profile_scope_, __LINE__)(obd2_server::profile_phase::phase)
+#define OBD2_PROFILE_CYCLE_BEGIN() obd2_server::profiler::get().begin_cycle()
+#define OBD2_PROFILE_CYCLE_END() obd2_server::profiler::get().end_cycle()
+#define OBD2_PROFILE_EXCHANGE(service, payload_size) obd2_server::profiler::get().record_exchange(service, payload_size)
+#define OBD2_PROFILE_REPORT(stream) obd2_server::profiler::get().print(stream)
+#define OBD2_PROFILE_SUMMARY(stream) obd2_server::profiler::get().print(stream, obd2_server::profiler::get().get_total())
+#else
+#define OBD2_PROFILE_SCOPE(phase)
+#define OBD2_PROFILE_CYCLE_BEGIN()
+#define OBD2_PROFILE_CYCLE_END()
+#define OBD2_PROFILE_EXCHANGE(service, payload_size)
+#define OBD2_PROFILE_REPORT(stream)
+#define OBD2_PROFILE_SUMMARY(stream)
+#endif
+
+namespace obd2_server {
+    enum class profile_phase : uint8_t {
+        waiting,
+        decoding,
+        displaying,
+        logging,
+        count
+    };
+
+    // Splits refresh intervals into phases and estimates the CAN traffic they cause
+    class profiler {
+        public:
+            struct report {
+                std::array<uint64_t, size_t(profile_phase::count)> phase_ns = {};
+                uint64_t duration_ns = 0;
+                uint64_t cycles = 0;
+                uint64_t frames = 0;
+                uint64_t bits = 0;
+            };
+
+        private:
+            // Classic CAN frame with 11 bit id and 8 data bytes, worst case stuffing and interframe space
+            static constexpr uint64_t BITS_PER_FRAME = 135;
+            static constexpr size_t SINGLE_FRAME_BYTES = 7;
+            static constexpr size_t FIRST_FRAME_BYTES = 6;
+            static constexpr size_t CONSECUTIVE_FRAME_BYTES = 7;
+            static constexpr std::chrono::nanoseconds REPORT_WINDOW = std::chrono::seconds(1);
+
+            std::array<std::atomic<uint64_t>, size_t(profile_phase::count)> phase_ns = {};
+            std::atomic<uint64_t> cycles = 0;
+            std::atomic<uint64_t> frames = 0;
+            std::atomic<uint32_t> bitrate = 500000;
+            std::chrono::steady_clock::time_point window_start;
+            std::chrono::steady_clock::time_point last_cycle_end;
+            report last_report;
+            report total;
+
+            profiler();
+
+        public:
+            static profiler &get();
+
+            void set_bitrate(uint32_t bitrate);
+            void add(profile_phase phase, uint64_t ns);
+            void begin_cycle();
+            void end_cycle();
+
+            // One request and its response, payload_size is 0 if the ECU did not answer
+            void record_exchange(uint8_t service, size_t payload_size);
+
+            // Last complete report window and everything since the start
+            const report &get_last_report() const;
+            const report &get_total() const;
+            void print(std::ostream &os) const;
+            void print(std::ostream &os, const report &r) const;
+    };
+
+    class profile_scope {
+        private:
+            profile_phase phase;
+            std::chrono::steady_clock::time_point start;
+
+        public:
+            profile_scope(profile_phase phase);
+            profile_scope(const profile_scope &) = delete;
+            ~profile_scope();
+
+            profile_scope &operator=(const profile_scope &) = delete;
+    };
+}
@@ -0,0 +1,180 @@
+#include "raw_log.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "../trace/tracer.h"
+
+namespace obd2_server {
+    static_assert(std::endian::native == std::endian::little, "Raw logs are stored in host byte order");
+
+    raw_log_writer::raw_log_writer() { }
+
+    raw_log_writer::raw_log_writer(const std::vector<std::string> &ids) :
+        raw_log_writer(ids, "obd2_raw_" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + ".bin") {}
+
+    raw_log_writer::raw_log_writer(const std::vector<std::string> &ids, const std::string &filename) 
+        : file(filename, std::ios::binary) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file " + filename);
+        }
+
+        file.write(RAW_LOG_MAGIC, sizeof(RAW_LOG_MAGIC));
+        write_ids(ids);
+        file.flush();
+    }
+
+    void raw_log_writer::write_ids(const std::vector<std::string> &ids) {
+        uint32_t channel_count = ids.size();
+
+        file.write(reinterpret_cast<const char *>(&channel_count), sizeof(channel_count));
+
+        for (const std::string &id : ids) {
+            file.write(id.data(), id.size());
+        }
+    }
+
+    void raw_log_writer::begin_sample(uint64_t timestamp) {
+        const char *bytes = reinterpret_cast<const char *>(&timestamp);
+
+        sample_buffer.clear();
+        sample_buffer.insert(sample_buffer.end(), bytes, bytes + sizeof(timestamp));
+    }
+
+    void raw_log_writer::write_payload(const std::vector<uint8_t> &payload) {
+        // The length prefix is a single byte, longer payloads are cut
+        uint8_t length = std::min<size_t>(payload.size(), UINT8_MAX);
+
+        sample_buffer.push_back(length);
+        sample_buffer.insert(sample_buffer.end(), payload.begin(), payload.begin() + length);
+    }
+
+    void raw_log_writer::end_sample() {
+        trace_scope trace("raw write");
+        file.write(sample_buffer.data(), sample_buffer.size());
+        file.flush();
+    }
+
+    void raw_log_writer::write_schema(const std::vector<std::string> &ids) {
+        uint64_t marker = RAW_LOG_SCHEMA_MARKER;
+
+        file.write(reinterpret_cast<const char *>(&marker), sizeof(marker));
+        write_ids(ids);
+        file.flush();
+    }
+
+    raw_log_reader::raw_log_reader() { }
+
+    raw_log_reader::raw_log_reader(const std::string &filename) : file(filename, std::ios::binary) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file " + filename);
+        }
+
+        char magic[sizeof(RAW_LOG_MAGIC)];
+
+        file.read(magic, sizeof(magic));
+
+        if (!file || std::memcmp(magic, RAW_LOG_MAGIC, sizeof(magic)) != 0) {
+            throw std::runtime_error(filename + " is not a raw log");
+        }
+
+        if (!read_ids()) {
+            throw std::runtime_error("Truncated raw log header in " + filename);
+        }
+    }
+
+    bool raw_log_reader::read_ids() {
+        uint32_t channel_count = 0;
+
+        file.read(reinterpret_cast<char *>(&channel_count), sizeof(channel_count));
+        ids.clear();
+
+        for (uint32_t i = 0; i < channel_count && file; i++) {
+            std::string id(16, '\0');
+            file.read(id.data(), id.size());
+            ids.push_back(id);
+        }
+
+        return bool(file);
+    }
+
+    const std::vector<std::string> &raw_log_reader::get_ids() const {
+        return ids;
+    }
+
+    size_t raw_log_reader::get_schema_version() const {
+        return schema_version;
+    }
+
+    size_t raw_log_reader::read_block(raw_block &block, size_t max_samples) {
+        uint64_t timestamp;
+
+        // Schema changes at the start of the block apply to it
+        while (file.read(reinterpret_cast<char *>(&timestamp), sizeof(timestamp)) && timestamp == RAW_LOG_SCHEMA_MARKER) {
+            if (!read_ids()) {
+                return 0;
+            }
+
+            schema_version++;
+        }
+
+        if (!file) {
+            return 0;
+        }
+
+        file.seekg(-std::streamoff(sizeof(timestamp)), std::ios::cur);
+        block.timestamps.clear();
+        block.channels.resize(ids.size());
+
+        for (raw_block::channel &c : block.channels) {
+            c.lengths.assign(max_samples, 0);
+
+            for (std::vector<uint8_t> &column : c.columns) {
+                column.assign(max_samples, 0);
+            }
+        }
+
+        uint8_t payload[UINT8_MAX];
+        size_t count = 0;
+
+        while (count < max_samples) {
+            if (!file.read(reinterpret_cast<char *>(&timestamp), sizeof(timestamp))) {
+                break;
+            }
+
+            if (timestamp == RAW_LOG_SCHEMA_MARKER) {
+                file.seekg(-std::streamoff(sizeof(timestamp)), std::ios::cur);
+                break;
+            }
+
+            for (raw_block::channel &c : block.channels) {
+                uint8_t length = 0;
+
+                file.read(reinterpret_cast<char *>(&length), sizeof(length));
+                file.read(reinterpret_cast<char *>(payload), length);
+
+                while (c.columns.size() < length) {
+                    c.columns.emplace_back(max_samples, 0);
+                }
+
+                c.lengths[count] = length;
+
+                for (size_t k = 0; k < length; k++) {
+                    c.columns[k][count] = payload[k];
+                }
+            }
+
+            // Drop a sample cut off by an interrupted logger
+            if (!file) {
+                break;
+            }
+
+            block.timestamps.push_back(timestamp);
+            count++;
+        }
+
+        return count;
+    }
+}
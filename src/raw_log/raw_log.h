@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <uuid_v4.h>
+
+namespace obd2_server {
+    // Binary log of raw response payloads, all integers little endian.
+    //   header: "OBD2RAW1", uint32 channel count, 16 byte request id per channel
+    //   sample: uint64 unix timestamp in ms, per channel an uint8 length followed by the payload
+    //   schema change: uint64 RAW_LOG_SCHEMA_MARKER, then channel count and ids like the header
+    // A zero length marks a channel without response. Samples after a schema change use its channels.
+    static constexpr char RAW_LOG_MAGIC[8] = { 'O', 'B', 'D', '2', 'R', 'A', 'W', '1' };
+    static constexpr uint64_t RAW_LOG_SCHEMA_MARKER = UINT64_MAX;
+
+    // Column oriented view of consecutive samples
+    struct raw_block {
+        struct channel {
+            std::vector<uint8_t> lengths;
+
+            // columns[k][i] is payload byte k of sample i, zero if the payload is shorter
+            std::vector<std::vector<uint8_t>> columns;
+        };
+
+        std::vector<uint64_t> timestamps;
+        std::vector<channel> channels;
+    };
+
+    class raw_log_writer {
+        private:
+            std::ofstream file;
+            std::vector<char> sample_buffer;
+
+            void write_ids(const std::vector<std::string> &ids);
+
+        public:
+            raw_log_writer();
+            raw_log_writer(const std::vector<std::string> &ids);
+            raw_log_writer(const std::vector<std::string> &ids, const std::string &filename);
+
+            // A sample is written as begin_sample, one write_payload per channel in header order, end_sample
+            void begin_sample(uint64_t timestamp);
+            void write_payload(const std::vector<uint8_t> &payload);
+            void end_sample();
+            // Switches the following samples to other channels
+            void write_schema(const std::vector<std::string> &ids);
+    };
+
+    class raw_log_reader {
+        private:
+            std::ifstream file;
+            std::vector<std::string> ids;
+            size_t schema_version = 0;
+
+            bool read_ids();
+
+        public:
+            raw_log_reader();
+            raw_log_reader(const std::string &filename);
+
+            // Request ids in the byte form of UUIDv4::UUID::bytes()
+            const std::vector<std::string> &get_ids() const;
+            // Counts the schema changes read so far, the ids change along with it
+            size_t get_schema_version() const;
+
+            // Reads up to max_samples samples, returns the number read (0 at the end of the log).
+            // A block ends before a schema change, so all its samples share the current ids.
+            size_t read_block(raw_block &block, size_t max_samples);
+    };
+}
@@ -0,0 +1,116 @@
+#include "refresh_controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace obd2_server {
+    refresh_controller::refresh_controller() { }
+
+    refresh_controller::refresh_controller(uint32_t min_ms, uint32_t max_ms, uint32_t initial_ms, const std::string &telemetry_file)
+        : min_ms(min_ms), max_ms(max_ms), reason("initial") {
+        // Checked before clamping, which requires min_ms <= max_ms, and before creating the file
+        if (min_ms == 0 || min_ms > max_ms) {
+            throw std::invalid_argument("Invalid refresh bounds");
+        }
+
+        refresh_ms = std::clamp(initial_ms, min_ms, max_ms);
+        telemetry.open(telemetry_file);
+
+        if (!telemetry.is_open()) {
+            throw std::runtime_error("Cannot open file " + telemetry_file);
+        }
+
+        telemetry << "\"timestamp\",\"refresh_ms\",\"cycle_ms\",\"reason\"" << std::endl;
+    }
+
+    bool refresh_controller::is_enabled() const {
+        return max_ms != 0;
+    }
+
+    bool refresh_controller::update(uint64_t now_ms, const std::vector<ecu_sample> &ecus) {
+        if (last_cycle != 0) {
+            double interval = now_ms - last_cycle;
+            cycle_ms = cycle_ms == 0 ? interval : cycle_ms + CYCLE_SMOOTHING * (interval - cycle_ms);
+        }
+
+        last_cycle = now_ms;
+
+        for (const ecu_sample &sample : ecus) {
+            auto it = std::find_if(window.begin(), window.end(), [&](const ecu_window &w) noexcept { return w.ecu == sample.ecu; });
+
+            if (it == window.end()) {
+                window.push_back({ sample.ecu, 0, 0 });
+                it = window.end() - 1;
+            }
+
+            it->requests += sample.requests;
+            it->timeouts += sample.requests - sample.responses;
+        }
+
+        if (++window_cycles < WINDOW_CYCLES) {
+            return false;
+        }
+
+        // The ECU answering worst decides whether to back off
+        const ecu_window *worst = nullptr;
+        double worst_ratio = 0;
+
+        for (const ecu_window &w : window) {
+            double ratio = w.requests ? double(w.timeouts) / w.requests : 0;
+
+            if (worst == nullptr || ratio > worst_ratio) {
+                worst = &w;
+                worst_ratio = ratio;
+            }
+        }
+
+        uint32_t old_ms = refresh_ms;
+        std::stringstream ss;
+
+        if (worst != nullptr && worst_ratio > MAX_TIMEOUT_RATIO) {
+            ss << "ECU " << std::hex << worst->ecu << std::dec << " missed " << std::lround(worst_ratio * 100) << "% of responses";
+            change(now_ms, std::ceil(refresh_ms * RELAX_FACTOR), ss.str());
+        }
+        else if (cycle_ms > refresh_ms * BEHIND_RATIO) {
+            ss << "cycle takes " << std::lround(cycle_ms) << " ms";
+            change(now_ms, std::ceil(cycle_ms), ss.str());
+        }
+        else if (worst_ratio <= MIN_TIMEOUT_RATIO) {
+            change(now_ms, std::floor(refresh_ms * TIGHTEN_FACTOR), "ECUs keep up");
+        }
+
+        window.clear();
+        window_cycles = 0;
+
+        return refresh_ms != old_ms;
+    }
+
+    void refresh_controller::change(uint64_t now_ms, uint32_t new_ms, const std::string &new_reason) {
+        new_ms = std::clamp(new_ms, min_ms, max_ms);
+
+        if (new_ms == refresh_ms) {
+            return;
+        }
+
+        refresh_ms = new_ms;
+        reason = new_reason;
+
+        telemetry << now_ms << "," << refresh_ms << "," << std::fixed << std::setprecision(1) << cycle_ms 
+            << ",\"" << reason << "\"" << std::endl;
+    }
+
+    uint32_t refresh_controller::get_refresh_ms() const {
+        return refresh_ms;
+    }
+
+    double refresh_controller::get_cycle_ms() const {
+        return cycle_ms;
+    }
+
+    const std::string &refresh_controller::get_reason() const {
+        return reason;
+    }
+}
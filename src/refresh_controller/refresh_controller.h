@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace obd2_server {
+    // Adjusts the polling period between user set bounds based on the measured
+    // cycle time and the share of requests each ECU leaves unanswered
+    class refresh_controller {
+        public:
+            struct ecu_sample {
+                uint32_t ecu;
+                uint32_t requests;
+                uint32_t responses;
+            };
+
+        private:
+            // Cycles per decision
+            static constexpr uint32_t WINDOW_CYCLES = 8;
+            // Share of missed responses from one ECU that makes the period longer,
+            // below the lower bound the period gets shorter
+            static constexpr double MAX_TIMEOUT_RATIO = 0.1;
+            static constexpr double MIN_TIMEOUT_RATIO = 0.02;
+            // Cycle time relative to the period at which the ECUs are considered behind
+            static constexpr double BEHIND_RATIO = 2.0;
+            static constexpr double RELAX_FACTOR = 1.25;
+            static constexpr double TIGHTEN_FACTOR = 0.9;
+            static constexpr double CYCLE_SMOOTHING = 0.25;
+
+            struct ecu_window {
+                uint32_t ecu;
+                uint32_t requests;
+                uint32_t timeouts;
+            };
+
+            uint32_t min_ms = 0;
+            uint32_t max_ms = 0;
+            uint32_t refresh_ms = 0;
+            std::ofstream telemetry;
+            std::string reason;
+
+            uint64_t last_cycle = 0;
+            double cycle_ms = 0;
+            uint32_t window_cycles = 0;
+            std::vector<ecu_window> window;
+
+            void change(uint64_t now_ms, uint32_t new_ms, const std::string &new_reason);
+
+        public:
+            refresh_controller();
+            // Every change is appended to telemetry_file as timestamp, refresh_ms, cycle_ms, reason
+            refresh_controller(uint32_t min_ms, uint32_t max_ms, uint32_t initial_ms, const std::string &telemetry_file);
+
+            bool is_enabled() const;
+
+            // Feeds one finished refresh cycle, returns true if the period changed
+            bool update(uint64_t now_ms, const std::vector<ecu_sample> &ecus);
+
+            uint32_t get_refresh_ms() const;
+            double get_cycle_ms() const;
+            const std::string &get_reason() const;
+    };
+}
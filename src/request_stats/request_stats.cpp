@@ -0,0 +1,140 @@
+#include "request_stats.h"
+
+#include <bit>
+
+namespace obd2_server {
+    size_t latency_histogram::get_bucket(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) {
+            return value;
+        }
+
+        unsigned shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+
+        if (shift > MAX_SHIFT) {
+            return BUCKET_COUNT - 1;
+        }
+
+        return SUB_BUCKET_COUNT * (shift + 1) + (value >> shift) - SUB_BUCKET_COUNT;
+    }
+
+    uint64_t latency_histogram::get_bucket_value(size_t bucket) {
+        if (bucket < SUB_BUCKET_COUNT) {
+            return bucket;
+        }
+
+        unsigned shift = bucket / SUB_BUCKET_COUNT - 1;
+        uint64_t sub_bucket = bucket % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    void latency_histogram::record(uint64_t value) {
+        buckets[get_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current = max.load(std::memory_order_relaxed);
+
+        while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+    }
+
+    uint64_t latency_histogram::get_count() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t latency_histogram::get_max() const {
+        return max.load(std::memory_order_relaxed);
+    }
+
+    double latency_histogram::get_mean() const {
+        uint64_t n = get_count();
+        return n ? double(sum.load(std::memory_order_relaxed)) / n : 0;
+    }
+
+    uint64_t latency_histogram::get_percentile(double percentile) const {
+        uint64_t n = get_count();
+
+        if (n == 0) {
+            return 0;
+        }
+
+        uint64_t target = std::max<uint64_t>(1, percentile / 100 * n + 0.5);
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+
+            if (seen >= target) {
+                return std::min(get_bucket_value(i), get_max());
+            }
+        }
+
+        return get_max();
+    }
+
+    void request_stats::record(uint64_t timestamp_ms, const std::vector<uint8_t> &raw) {
+        if (first_sample.load(std::memory_order_relaxed) == 0) {
+            first_sample.store(timestamp_ms, std::memory_order_relaxed);
+        }
+
+        last_sample.store(timestamp_ms, std::memory_order_relaxed);
+
+        if (raw.empty()) {
+            timeouts.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (raw[0] == NEGATIVE_RESPONSE) {
+            negative_responses.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        uint64_t previous = last_success.exchange(timestamp_ms, std::memory_order_relaxed);
+
+        if (previous != 0) {
+            latency_us.record((timestamp_ms - previous) * 1000);
+        }
+
+        successes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t request_stats::get_successes() const {
+        return successes.load(std::memory_order_relaxed);
+    }
+
+    uint64_t request_stats::get_timeouts() const {
+        return timeouts.load(std::memory_order_relaxed);
+    }
+
+    uint64_t request_stats::get_negative_responses() const {
+        return negative_responses.load(std::memory_order_relaxed);
+    }
+
+    double request_stats::get_sample_rate() const {
+        uint64_t duration_ms = last_sample.load(std::memory_order_relaxed) - first_sample.load(std::memory_order_relaxed);
+        return duration_ms ? get_successes() * 1000.0 / duration_ms : 0;
+    }
+
+    const latency_histogram &request_stats::get_latency_us() const {
+        return latency_us;
+    }
+
+    void to_json(nlohmann::json &j, const request_stats &s) {
+        const latency_histogram &h = s.latency_us;
+
+        j = nlohmann::json{
+            {"successes", s.get_successes()},
+            {"timeouts", s.get_timeouts()},
+            {"negative_responses", s.get_negative_responses()},
+            {"sample_rate_hz", s.get_sample_rate()},
+            {"latency_ms", {
+                {"count", h.get_count()},
+                {"mean", h.get_mean() / 1000},
+                {"p50", h.get_percentile(50) / 1000.0},
+                {"p90", h.get_percentile(90) / 1000.0},
+                {"p99", h.get_percentile(99) / 1000.0},
+                {"max", h.get_max() / 1000.0}
+            }}
+        };
+    }
+}
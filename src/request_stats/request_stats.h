@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <json.hpp>
+
+namespace obd2_server {
+    // Log-linear histogram in the style of HdrHistogram, 16 buckets per power of two
+    // (about 6% relative error). Recording is wait-free, reading may run concurrently.
+    class latency_histogram {
+        private:
+            static constexpr unsigned SUB_BUCKET_BITS = 4;
+            static constexpr uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+            static constexpr unsigned MAX_SHIFT = 32;
+            static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT * (MAX_SHIFT + 2);
+
+            std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets = {};
+            std::atomic<uint64_t> count = 0;
+            std::atomic<uint64_t> sum = 0;
+            std::atomic<uint64_t> max = 0;
+
+            static size_t get_bucket(uint64_t value);
+            static uint64_t get_bucket_value(size_t bucket);
+
+        public:
+            void record(uint64_t value);
+
+            uint64_t get_count() const;
+            uint64_t get_max() const;
+            double get_mean() const;
+            // Upper bound of the bucket holding the given percentile (0 to 100)
+            uint64_t get_percentile(double percentile) const;
+    };
+
+    // Response statistics of a single request, fed once per refresh cycle.
+    // As responses are only seen at the end of a cycle, latency is the time between
+    // two successful updates of the request, which includes cycles it went unanswered.
+    class request_stats {
+        private:
+            static constexpr uint8_t NEGATIVE_RESPONSE = 0x7F;
+
+            latency_histogram latency_us;
+            std::atomic<uint64_t> successes = 0;
+            std::atomic<uint64_t> timeouts = 0;
+            std::atomic<uint64_t> negative_responses = 0;
+            std::atomic<uint64_t> first_sample = 0;
+            std::atomic<uint64_t> last_sample = 0;
+            std::atomic<uint64_t> last_success = 0;
+
+        public:
+            void record(uint64_t timestamp_ms, const std::vector<uint8_t> &raw);
+
+            uint64_t get_successes() const;
+            uint64_t get_timeouts() const;
+            uint64_t get_negative_responses() const;
+            // Successful updates per second since the first sample
+            double get_sample_rate() const;
+            const latency_histogram &get_latency_us() const;
+
+            friend void to_json(nlohmann::json &j, const request_stats &s);
+    };
+
+    void to_json(nlohmann::json &j, const request_stats &s);
+}
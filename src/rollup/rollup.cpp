@@ -0,0 +1,105 @@
+#include "rollup.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace obd2_server {
+    rollup::rollup() { }
+
+    rollup::rollup(const std::vector<std::string> &names, const std::vector<int> &precisions, const std::string &prefix) {
+        std::vector<std::string> header;
+        std::vector<int> window_precisions;
+
+        header.push_back("timestamp");
+
+        for (size_t i = 0; i < names.size(); i++) {
+            int precision = i < precisions.size() ? precisions[i] : -1;
+
+            header.push_back(names[i] + " min");
+            header.push_back(names[i] + " max");
+            header.push_back(names[i] + " mean");
+            header.push_back(names[i] + " last");
+
+            // The mean resolves one digit more than its inputs
+            window_precisions.insert(window_precisions.end(), { precision, precision, precision < 0 ? -1 : precision + 1, precision });
+        }
+
+        for (const window_size &size : WINDOW_SIZES) {
+            window &w = windows.emplace_back();
+
+            w.ms = size.ms;
+            w.aggregates.resize(names.size());
+            w.output = csv_logger(header, prefix + "_" + size.suffix + ".csv");
+            w.output.set_precisions(window_precisions);
+        }
+
+        row.resize(names.size() * 4);
+    }
+
+    void rollup::push(uint64_t timestamp, const std::vector<float> &values) {
+        for (window &w : windows) {
+            uint64_t start = timestamp - timestamp % w.ms;
+
+            if (start != w.start) {
+                if (w.start != 0) {
+                    emit(w);
+                }
+
+                reset(w, start);
+            }
+
+            for (size_t i = 0; i < w.aggregates.size() && i < values.size(); i++) {
+                aggregate &a = w.aggregates[i];
+                float value = values[i];
+
+                // Missing responses do not count towards the window
+                if (std::isnan(value)) {
+                    continue;
+                }
+
+                a.min = std::min(a.min, value);
+                a.max = std::max(a.max, value);
+                a.last = value;
+                a.sum += value;
+                a.count++;
+            }
+        }
+    }
+
+    void rollup::finish() {
+        for (window &w : windows) {
+            if (w.start != 0) {
+                emit(w);
+                w.start = 0;
+            }
+        }
+    }
+
+    bool rollup::is_open() const {
+        return !windows.empty();
+    }
+
+    void rollup::reset(window &w, uint64_t start) {
+        const float inf = std::numeric_limits<float>::infinity();
+
+        w.start = start;
+        std::fill(w.aggregates.begin(), w.aggregates.end(), aggregate{ inf, -inf, 0, 0, 0 });
+    }
+
+    void rollup::emit(window &w) {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+
+        for (size_t i = 0; i < w.aggregates.size(); i++) {
+            const aggregate &a = w.aggregates[i];
+            bool empty = a.count == 0;
+
+            row[i * 4] = empty ? nan : a.min;
+            row[i * 4 + 1] = empty ? nan : a.max;
+            row[i * 4 + 2] = empty ? nan : a.sum / a.count;
+            row[i * 4 + 3] = empty ? nan : a.last;
+        }
+
+        w.output.write_row(w.start, row);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../csv_logger/csv_logger.h"
+
+namespace obd2_server {
+    // Aggregates samples into fixed time windows (1 s, 10 s, 1 min) with min, max, mean and
+    // last value per channel. Each window size goes to its own csv file <prefix>_<window>.csv.
+    class rollup {
+        private:
+            struct window_size {
+                uint32_t ms;
+                const char *suffix;
+            };
+
+            static constexpr window_size WINDOW_SIZES[] = {
+                { 1000, "1s" },
+                { 10000, "10s" },
+                { 60000, "1min" }
+            };
+
+            struct aggregate {
+                float min;
+                float max;
+                float last;
+                double sum;
+                uint32_t count;
+            };
+
+            struct window {
+                uint32_t ms;
+                uint64_t start = 0;
+                std::vector<aggregate> aggregates;
+                csv_logger output;
+            };
+
+            std::vector<window> windows;
+            std::vector<float> row;
+
+            void reset(window &w, uint64_t start);
+            void emit(window &w);
+
+        public:
+            rollup();
+            rollup(const std::vector<std::string> &names, const std::vector<int> &precisions, const std::string &prefix);
+
+            // Timestamps in ms, windows are aligned to multiples of their size
+            void push(uint64_t timestamp, const std::vector<float> &values);
+            // Writes the windows still open, call once after the last sample
+            void finish();
+            bool is_open() const;
+    };
+}
@@ -0,0 +1,100 @@
+#include "rule_engine.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace obd2_server {
+    rule_engine::rule_engine() { }
+
+    rule_engine::rule_engine(const vehicle &v, const std::vector<std::string> &names, const std::vector<std::string> &ids) 
+        : missing_slot(names.size()) {
+        uuid_table value_ids(ids);
+        uuid_table known_ids;
+
+        for (const request &r : v.get_requests()) {
+            known_ids.push_back(r.id);
+        }
+
+        for (const virtual_channel &c : v.get_virtual_channels()) {
+            known_ids.push_back(c.id);
+        }
+
+        for (const rule &r : v.get_rules()) {
+            compiled_rule &c = rules.emplace_back();
+            c.definition = &r;
+
+            try {
+                c.condition = formula(r.condition);
+            }
+            catch (std::invalid_argument &e) {
+                throw std::invalid_argument("Rule " + r.name + ": " + e.what());
+            }
+
+            if (c.condition.get_required_bytes() != 0) {
+                throw std::invalid_argument("Rule " + r.name + " refers to payload bytes");
+            }
+
+            for (const std::string &reference : c.condition.get_variables()) {
+                auto name = std::find(names.begin(), names.end(), reference);
+                size_t id = value_ids.find_string(reference);
+                auto matches = [&reference](const auto &channel) noexcept {
+                    return channel.name == reference;
+                };
+
+                if (name != names.end()) {
+                    c.sources.push_back(name - names.begin());
+                }
+                else if (id != uuid_table::NPOS) {
+                    c.sources.push_back(id);
+                }
+                else if (known_ids.find_string(reference) != uuid_table::NPOS
+                    || std::any_of(v.get_requests().begin(), v.get_requests().end(), matches) 
+                    || std::any_of(v.get_virtual_channels().begin(), v.get_virtual_channels().end(), matches)) {
+                    c.sources.push_back(missing_slot);
+                }
+                else {
+                    throw std::invalid_argument("Rule " + r.name + " refers to unknown channel " + reference);
+                }
+            }
+
+            c.state.assign(c.condition.get_state_size(), 0);
+        }
+    }
+
+    const std::vector<const rule *> &rule_engine::update(uint64_t timestamp, const float *values) {
+        fired.clear();
+
+        for (compiled_rule &r : rules) {
+            arguments.resize(r.sources.size());
+
+            for (size_t i = 0; i < r.sources.size(); i++) {
+                arguments[i] = r.sources[i] == missing_slot ? std::numeric_limits<float>::quiet_NaN() : values[r.sources[i]];
+            }
+
+            float value = r.condition.evaluate(arguments.data(), timestamp, r.state.data());
+
+            // NaN counts as false, like in the condition itself
+            if (!(value < 0 || value > 0)) {
+                r.since = 0;
+                r.fired = false;
+                continue;
+            }
+
+            if (r.since == 0) {
+                r.since = timestamp;
+            }
+
+            if (!r.fired && timestamp - r.since >= r.definition->for_ms) {
+                r.fired = true;
+                fired.push_back(r.definition);
+            }
+        }
+
+        return fired;
+    }
+
+    bool rule_engine::empty() const {
+        return rules.empty();
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../formula/formula.h"
+#include "../vehicle/vehicle.h"
+
+namespace obd2_server {
+    // Evaluates the rules of a vehicle once per snapshot. A rule fires once when its condition
+    // held for its duration and fires again only after the condition was false.
+    class rule_engine {
+        private:
+            struct compiled_rule {
+                const rule *definition;
+                formula condition;
+                std::vector<size_t> sources;
+                std::vector<double> state;
+                uint64_t since = 0;
+                bool fired = false;
+            };
+
+            std::vector<compiled_rule> rules;
+            std::vector<const rule *> fired;
+            std::vector<float> arguments;
+            size_t missing_slot = 0;
+
+        public:
+            rule_engine();
+            // names and ids (byte form) describe the values passed to update, in that order.
+            // References to channels of the vehicle that are not among them evaluate as missing values.
+            rule_engine(const vehicle &v, const std::vector<std::string> &names, const std::vector<std::string> &ids);
+
+            // Timestamps in ms, returns the rules fired by this snapshot
+            const std::vector<const rule *> &update(uint64_t timestamp, const float *values);
+            bool empty() const;
+    };
+}
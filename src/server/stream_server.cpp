@@ -0,0 +1,327 @@
+#include "stream_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace obd2_server {
+    static constexpr int POLL_TIMEOUT_MS = 1000;
+
+    stream_server::stream_server(const std::string &socket_path, const std::vector<std::string> &ids) 
+        : socket_path(socket_path), id_table(ids), id_strings(id_table.format(' ')), line_offsets(ids.size()), line_lengths(ids.size()), subscribers(ids.size()) {
+
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+
+        if (socket_path.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument("Socket path too long: " + socket_path);
+        }
+
+        std::strcpy(addr.sun_path, socket_path.c_str());
+        unlink(socket_path.c_str());
+
+        listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+        if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listen_fd, SOMAXCONN) < 0) {
+            std::string error = std::strerror(errno);
+
+            if (listen_fd >= 0) {
+                close(listen_fd);
+            }
+
+            throw std::runtime_error("Cannot listen on " + socket_path + ": " + error);
+        }
+
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (wake_fd < 0) {
+            close(listen_fd);
+            unlink(socket_path.c_str());
+            throw std::runtime_error(std::string("Cannot create eventfd: ") + std::strerror(errno));
+        }
+
+        thread = std::thread(&stream_server::run, this);
+    }
+
+    stream_server::~stream_server() {
+        stopping = true;
+        eventfd_write(wake_fd, 1);
+        thread.join();
+
+        for (client &c : clients) {
+            close(c.fd);
+        }
+
+        close(wake_fd);
+        close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+
+    void stream_server::publish(uint64_t timestamp, const std::vector<float> &values) {
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex);
+            published_values.assign(values.begin(), values.end());
+            published_timestamp = timestamp;
+            frame_pending = true;
+        }
+
+        eventfd_write(wake_fd, 1);
+    }
+
+    bool stream_server::is_subscribed(size_t index) const {
+        return subscribers[index].load(std::memory_order_acquire) != 0;
+    }
+
+    size_t stream_server::get_client_count() const {
+        return client_count;
+    }
+
+    void stream_server::run() {
+        std::vector<pollfd> fds;
+
+        while (!stopping) {
+            fds.clear();
+            fds.push_back({ wake_fd, POLLIN, 0 });
+            fds.push_back({ listen_fd, POLLIN, 0 });
+
+            for (const client &c : clients) {
+                fds.push_back({ c.fd, short(POLLIN | (c.pending.empty() ? 0 : POLLOUT)), 0 });
+            }
+
+            if (poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) < 0) {
+                continue;
+            }
+
+            // Clients accepted below have no poll entry yet
+            size_t polled_clients = clients.size();
+
+            for (size_t i = 0; i < polled_clients; i++) {
+                client &c = clients[i];
+                short events = fds[i + 2].revents;
+
+                if (events & (POLLERR | POLLHUP | POLLNVAL)) {
+                    c.closed = true;
+                    continue;
+                }
+
+                if (events & POLLIN) {
+                    read_client(c);
+                }
+
+                if (events & POLLOUT) {
+                    write_client(c);
+                }
+            }
+
+            if (fds[0].revents & POLLIN) {
+                eventfd_t count;
+                eventfd_read(wake_fd, &count);
+
+                bool has_frame = false;
+
+                {
+                    std::lock_guard<std::mutex> lock(frame_mutex);
+
+                    if (frame_pending) {
+                        values.swap(published_values);
+                        timestamp = published_timestamp;
+                        frame_pending = false;
+                        has_frame = true;
+                    }
+                }
+
+                if (has_frame) {
+                    fan_out();
+                }
+            }
+
+            if (fds[1].revents & POLLIN) {
+                accept_clients();
+            }
+
+            auto now = std::chrono::steady_clock::now();
+
+            for (client &c : clients) {
+                if (c.stalled && now - c.stalled_since > MAX_STALL) {
+                    c.closed = true;
+                }
+
+                if (c.closed) {
+                    close(c.fd);
+
+                    for (const subscription &s : c.subscriptions) {
+                        subscribers[s.index].fetch_sub(1, std::memory_order_release);
+                    }
+                }
+            }
+
+            std::erase_if(clients, [](const client &c) noexcept { return c.closed; });
+            client_count = clients.size();
+        }
+    }
+
+    void stream_server::accept_clients() {
+        while (true) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+            if (fd < 0) {
+                return;
+            }
+
+            client c;
+            c.fd = fd;
+            clients.push_back(std::move(c));
+        }
+    }
+
+    void stream_server::read_client(client &c) {
+        char buffer[1024];
+
+        while (true) {
+            ssize_t received = recv(c.fd, buffer, sizeof(buffer), 0);
+
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR)) {
+                c.closed = true;
+                return;
+            }
+
+            if (received < 0) {
+                break;
+            }
+
+            c.input.append(buffer, received);
+        }
+
+        size_t start = 0;
+        size_t end;
+
+        while ((end = c.input.find('\n', start)) != std::string::npos) {
+            handle_command(c, c.input.substr(start, end - start));
+            start = end + 1;
+        }
+
+        c.input.erase(0, start);
+
+        if (c.input.size() > MAX_LINE_LENGTH) {
+            c.closed = true;
+        }
+    }
+
+    void stream_server::handle_command(client &c, const std::string &line) {
+        std::istringstream ss(line);
+        std::string command;
+        std::string id_string;
+        uint32_t interval_ms = 0;
+
+        ss >> command >> id_string;
+
+        if (!(ss >> interval_ms)) {
+            interval_ms = 0;
+        }
+
+        size_t index = id_table.find_string(id_string);
+
+        if (command != "subscribe" && command != "unsubscribe") {
+            c.pending += "error unknown command\n";
+        }
+        else if (index == uuid_table::NPOS) {
+            c.pending += "error unknown request " + id_string + "\n";
+        }
+        else {
+            if (std::erase_if(c.subscriptions, [&](const subscription &s) noexcept { return s.index == index; }) != 0) {
+                subscribers[index].fetch_sub(1, std::memory_order_release);
+            }
+
+            if (command == "subscribe") {
+                // Counted before reading the clock, so a frame decoded without this subscription is older
+                subscribers[index].fetch_add(1, std::memory_order_release);
+                uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                c.subscriptions.push_back({ index, interval_ms, 0, now });
+            }
+        }
+
+        if (!c.pending.empty()) {
+            write_client(c);
+        }
+    }
+
+    void stream_server::write_client(client &c) {
+        while (!c.pending.empty()) {
+            ssize_t sent = send(c.fd, c.pending.data(), c.pending.size(), MSG_NOSIGNAL);
+
+            if (sent < 0) {
+                if (errno != EAGAIN && errno != EINTR) {
+                    c.closed = true;
+                }
+
+                // The stall starts when data is first left behind, a later partial write keeps it
+                if (!c.stalled) {
+                    c.stalled = true;
+                    c.stalled_since = std::chrono::steady_clock::now();
+                }
+
+                return;
+            }
+
+            c.pending.erase(0, sent);
+        }
+
+        c.stalled = false;
+    }
+
+    void stream_server::fan_out() {
+        std::fill(line_lengths.begin(), line_lengths.end(), 0);
+        encoded.clear();
+
+        for (client &c : clients) {
+            if (c.closed) {
+                continue;
+            }
+
+            // Downsample clients that have not taken the previous frame yet
+            if (!c.pending.empty()) {
+                c.skipped_frames++;
+                continue;
+            }
+
+            for (subscription &s : c.subscriptions) {
+                if (timestamp <= s.since || (s.last_sent != 0 && timestamp - s.last_sent < s.interval_ms)) {
+                    continue;
+                }
+
+                c.pending += get_line(s.index);
+                s.last_sent = timestamp;
+            }
+
+            write_client(c);
+        }
+    }
+
+    std::string_view stream_server::get_line(size_t index) {
+        if (line_lengths[index] == 0) {
+            char buffer[MAX_LINE_LENGTH];
+            char *out = buffer;
+            char *end = buffer + sizeof(buffer);
+
+            out = std::to_chars(out, end, timestamp).ptr;
+            *out++ = ' ';
+            out = std::copy_n(id_strings.data() + index * (uuid_table::STRING_LENGTH + 1), uuid_table::STRING_LENGTH + 1, out);
+            out = std::to_chars(out, end - 1, values[index]).ptr;
+            *out++ = '\n';
+
+            line_offsets[index] = encoded.size();
+            line_lengths[index] = out - buffer;
+            encoded.append(buffer, out);
+        }
+
+        return std::string_view(encoded).substr(line_offsets[index], line_lengths[index]);
+    }
+}
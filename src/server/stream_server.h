@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../uuid_table/uuid_table.h"
+
+namespace obd2_server {
+    // Streams request values to local clients over a Unix domain socket.
+    // Clients send text lines:
+    //   subscribe <request id> [interval_ms]
+    //   unsubscribe <request id>
+    // and receive one "<timestamp_ms> <request id> <value>" line per due sample.
+    class stream_server {
+        private:
+            struct subscription {
+                size_t index;
+                uint32_t interval_ms;
+                uint64_t last_sent;
+                // Frames up to this time may have been decoded before the subscription was seen
+                uint64_t since;
+            };
+
+            struct client {
+                int fd;
+                std::string input;
+                std::string pending;
+                std::vector<subscription> subscriptions;
+                // Set by write_client while pending holds data the socket did not take
+                std::chrono::steady_clock::time_point stalled_since;
+                bool stalled = false;
+                uint64_t skipped_frames = 0;
+                bool closed = false;
+            };
+
+            // A client that cannot take any data for this long is dropped
+            static constexpr std::chrono::milliseconds MAX_STALL = std::chrono::milliseconds(5000);
+            static constexpr size_t MAX_LINE_LENGTH = 256;
+
+            std::string socket_path;
+            uuid_table id_table;
+            // All ids as strings, formatted once for the lines sent
+            std::string id_strings;
+            int listen_fd = -1;
+            int wake_fd = -1;
+
+            std::thread thread;
+            std::atomic<bool> stopping = false;
+
+            // Latest published frame, overwritten if the server thread has not picked it up yet
+            std::mutex frame_mutex;
+            std::vector<float> published_values;
+            uint64_t published_timestamp = 0;
+            bool frame_pending = false;
+
+            // Frame owned by the server thread, each line is encoded at most once per frame
+            std::vector<float> values;
+            uint64_t timestamp = 0;
+            std::string encoded;
+            std::vector<uint32_t> line_offsets;
+            std::vector<uint16_t> line_lengths;
+
+            std::vector<client> clients;
+            std::atomic<size_t> client_count = 0;
+            // Subscriptions per request over all clients, read by the publisher
+            std::vector<std::atomic<uint32_t>> subscribers;
+
+            void run();
+            void accept_clients();
+            void read_client(client &c);
+            void handle_command(client &c, const std::string &line);
+            void write_client(client &c);
+            void fan_out();
+            std::string_view get_line(size_t index);
+
+        public:
+            // ids are the request ids in byte form, values are published in the same order
+            stream_server(const std::string &socket_path, const std::vector<std::string> &ids);
+            stream_server(const stream_server &) = delete;
+            ~stream_server();
+
+            stream_server &operator=(const stream_server &) = delete;
+
+            // Never blocks on clients, safe to call from the acquisition thread
+            void publish(uint64_t timestamp, const std::vector<float> &values);
+            // Whether any client subscribed to a request. Values of the others are never sent, so the
+            // publisher may skip decoding them. Take the frame timestamp before asking.
+            bool is_subscribed(size_t index) const;
+            size_t get_client_count() const;
+    };
+}
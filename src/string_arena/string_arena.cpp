@@ -0,0 +1,53 @@
+#include "string_arena.h"
+
+#include <cstring>
+
+namespace obd2_server {
+    string_arena::string_arena() { }
+
+    std::string_view string_arena::store(std::string_view s) {
+        if (s.empty()) {
+            return std::string_view("");
+        }
+
+        size_t size = s.size() + 1;
+
+        if (size > remaining) {
+            // Strings larger than a block get a block of their own, so the current one stays in use
+            if (size > BLOCK_SIZE / 4) {
+                blocks.emplace_back(new char[size]);
+                std::memcpy(blocks.back().get(), s.data(), s.size());
+                blocks.back()[s.size()] = '\0';
+                used += size;
+                return std::string_view(blocks.back().get(), s.size());
+            }
+
+            blocks.emplace_back(new char[BLOCK_SIZE]);
+            cursor = blocks.back().get();
+            remaining = BLOCK_SIZE;
+        }
+
+        char *out = cursor;
+        std::memcpy(out, s.data(), s.size());
+        out[s.size()] = '\0';
+        cursor += size;
+        remaining -= size;
+        used += size;
+
+        return std::string_view(out, s.size());
+    }
+
+    std::string_view string_arena::intern(std::string_view s) {
+        auto it = interned.find(s);
+
+        if (it != interned.end()) {
+            return *it;
+        }
+
+        return *interned.insert(store(s)).first;
+    }
+
+    size_t string_arena::get_size() const {
+        return used;
+    }
+}
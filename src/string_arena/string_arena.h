@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace obd2_server {
+    // Bump allocator for strings that live as long as the arena, e.g. the texts of a vehicle
+    // definition. Stored strings are never moved or freed individually.
+    class string_arena {
+        private:
+            static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+            std::vector<std::unique_ptr<char[]>> blocks;
+            char *cursor = nullptr;
+            size_t remaining = 0;
+            size_t used = 0;
+            std::unordered_set<std::string_view> interned;
+
+        public:
+            string_arena();
+            string_arena(const string_arena &) = delete;
+            string_arena &operator=(const string_arena &) = delete;
+
+            // Copies s into the arena, the view stays valid until the arena is destroyed.
+            // A terminating null follows every stored string, so data() can be passed as C string.
+            std::string_view store(std::string_view s);
+            // Like store, but equal strings share a single copy
+            std::string_view intern(std::string_view s);
+
+            // Bytes taken by stored strings
+            size_t get_size() const;
+    };
+}
@@ -0,0 +1,120 @@
+#include "tracer.h"
+
+#include <stdexcept>
+#include <json.hpp>
+
+namespace obd2_server {
+    tracer::tracer() { }
+
+    tracer &tracer::get() {
+        static tracer instance;
+        return instance;
+    }
+
+    uint64_t tracer::now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void tracer::start(const std::string &filename) {
+        if (is_enabled()) {
+            throw std::logic_error("Tracing already started");
+        }
+
+        file.open(filename);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file " + filename);
+        }
+
+        file << "{\"traceEvents\":[\n";
+        first_event = true;
+        enabled = true;
+        writer = std::thread(&tracer::run_writer, this);
+    }
+
+    void tracer::stop() {
+        if (!is_enabled()) {
+            return;
+        }
+
+        enabled = false;
+        writer.join();
+        drain();
+
+        file << "\n]}" << std::endl;
+        file.close();
+    }
+
+    void tracer::record(const char *name, uint64_t begin_us, uint64_t end_us, uint32_t track) {
+        thread_buffer &buffer = get_thread_buffer();
+        size_t head = buffer.head.load(std::memory_order_relaxed);
+
+        // Never wait for the writer, drop the event instead
+        if (head - buffer.tail.load(std::memory_order_acquire) >= thread_buffer::CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[head % thread_buffer::CAPACITY] = { name, begin_us, end_us, track ? track : buffer.track };
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    uint64_t tracer::get_dropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    tracer::thread_buffer &tracer::get_thread_buffer() {
+        thread_local thread_buffer *buffer = nullptr;
+
+        if (buffer == nullptr) {
+            std::lock_guard<std::mutex> lock(buffers_mutex);
+
+            buffers.push_back(std::make_unique<thread_buffer>());
+            buffer = buffers.back().get();
+            buffer->track = buffers.size();
+        }
+
+        return *buffer;
+    }
+
+    void tracer::run_writer() {
+        while (is_enabled()) {
+            std::this_thread::sleep_for(FLUSH_INTERVAL);
+            drain();
+        }
+    }
+
+    void tracer::drain() {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+
+        for (std::unique_ptr<thread_buffer> &buffer : buffers) {
+            size_t tail = buffer->tail.load(std::memory_order_relaxed);
+            size_t head = buffer->head.load(std::memory_order_acquire);
+
+            for (; tail != head; tail++) {
+                const event &e = buffer->events[tail % thread_buffer::CAPACITY];
+
+                file << (first_event ? "" : ",\n") << "{\"name\":" << nlohmann::json(e.name).dump() 
+                    << ",\"ph\":\"X\",\"ts\":" << e.begin_us << ",\"dur\":" << e.end_us - e.begin_us 
+                    << ",\"pid\":1,\"tid\":" << e.track << "}";
+                first_event = false;
+            }
+
+            buffer->tail.store(tail, std::memory_order_release);
+        }
+
+        file.flush();
+    }
+
+    trace_scope::trace_scope(const char *name) : name(name), begin_us(0) {
+        if (tracer::get().is_enabled()) {
+            begin_us = tracer::now_us();
+        }
+    }
+
+    trace_scope::~trace_scope() {
+        if (begin_us != 0 && tracer::get().is_enabled()) {
+            tracer::get().record(name, begin_us, tracer::now_us());
+        }
+    }
+}
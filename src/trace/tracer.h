@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace obd2_server {
+    // Collects timed spans into per-thread lock-free buffers and serializes them
+    // to a Chrome trace JSON file (chrome://tracing, ui.perfetto.dev) in the background
+    class tracer {
+        private:
+            struct event {
+                const char *name;
+                uint64_t begin_us;
+                uint64_t end_us;
+                uint32_t track;
+            };
+
+            // Single producer (the owning thread), single consumer (the writer thread)
+            struct thread_buffer {
+                static constexpr size_t CAPACITY = 8192;
+
+                std::array<event, CAPACITY> events;
+                std::atomic<size_t> head = 0;
+                std::atomic<size_t> tail = 0;
+                uint32_t track;
+            };
+
+            static constexpr std::chrono::milliseconds FLUSH_INTERVAL = std::chrono::milliseconds(100);
+
+            std::atomic<bool> enabled = false;
+            std::atomic<uint64_t> dropped = 0;
+            std::mutex buffers_mutex;
+            std::vector<std::unique_ptr<thread_buffer>> buffers;
+            std::ofstream file;
+            std::thread writer;
+            bool first_event = true;
+
+            tracer();
+
+            thread_buffer &get_thread_buffer();
+            void run_writer();
+            void drain();
+
+        public:
+            static tracer &get();
+
+            void start(const std::string &filename);
+            void stop();
+
+            bool is_enabled() const {
+                return enabled.load(std::memory_order_relaxed);
+            }
+
+            // Track 0 is the calling thread, others show up as separate rows in the viewer.
+            // name must stay valid until the tracer is stopped.
+            void record(const char *name, uint64_t begin_us, uint64_t end_us, uint32_t track = 0);
+            uint64_t get_dropped() const;
+
+            static uint64_t now_us();
+    };
+
+    // Records the span from construction to destruction if tracing is enabled
+    class trace_scope {
+        private:
+            const char *name;
+            uint64_t begin_us;
+
+        public:
+            trace_scope(const char *name);
+            trace_scope(const trace_scope &) = delete;
+            ~trace_scope();
+
+            trace_scope &operator=(const trace_scope &) = delete;
+    };
+}
@@ -0,0 +1,138 @@
+#include "uuid_table.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <x86/avx2.h>
+
+namespace obd2_server {
+    uuid_table::uuid_table() { }
+
+    uuid_table::uuid_table(const std::vector<std::string> &ids) {
+        keys.reserve(ids.size());
+
+        for (const std::string &id : ids) {
+            push_back(id);
+        }
+    }
+
+    void uuid_table::push_back(const UUIDv4::UUID &id) {
+        key k;
+        id.bytes(reinterpret_cast<char *>(k.bytes));
+        keys.push_back(k);
+    }
+
+    void uuid_table::push_back(const std::string &bytes) {
+        key k = {};
+        std::memcpy(k.bytes, bytes.data(), std::min(bytes.size(), sizeof(k.bytes)));
+        keys.push_back(k);
+    }
+
+    void uuid_table::erase(size_t index) {
+        keys.erase(keys.begin() + index);
+    }
+
+    void uuid_table::clear() {
+        keys.clear();
+    }
+
+    size_t uuid_table::find(const UUIDv4::UUID &id) const {
+        key needle;
+        id.bytes(reinterpret_cast<char *>(needle.bytes));
+        return find(needle);
+    }
+
+    size_t uuid_table::find_bytes(std::string_view bytes) const {
+        if (bytes.size() != sizeof(key::bytes)) {
+            return NPOS;
+        }
+
+        key needle;
+        std::memcpy(needle.bytes, bytes.data(), sizeof(needle.bytes));
+        return find(needle);
+    }
+
+    size_t uuid_table::find_string(std::string_view uuid) const {
+        if (!is_string(uuid)) {
+            return NPOS;
+        }
+
+        return find(UUIDv4::UUID::fromStrFactory(uuid.data()));
+    }
+
+    bool uuid_table::is_string(std::string_view uuid) {
+        // stom128i reads exactly 36 characters and does not check them
+        if (uuid.size() != STRING_LENGTH) {
+            return false;
+        }
+
+        for (size_t i = 0; i < STRING_LENGTH; i++) {
+            bool dash = i == 8 || i == 13 || i == 18 || i == 23;
+
+            if (dash ? uuid[i] != '-' : !std::isxdigit(static_cast<unsigned char>(uuid[i]))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    UUIDv4::UUID uuid_table::parse(std::string_view uuid) {
+        if (!is_string(uuid)) {
+            throw std::invalid_argument("Malformed id " + std::string(uuid));
+        }
+
+        return UUIDv4::UUID::fromStrFactory(uuid.data());
+    }
+
+    size_t uuid_table::find(const key &needle) const {
+        const size_t count = keys.size();
+        const simde__m128i n = simde_mm_load_si128(reinterpret_cast<const simde__m128i *>(needle.bytes));
+        const simde__m256i n2 = simde_mm256_broadcastsi128_si256(n);
+        size_t i = 0;
+
+        // Two keys per compare, a key matches if all of its 16 byte lanes do. Keys are only 16 byte
+        // aligned, so pairs of them are loaded unaligned.
+        for (; i + 2 <= count; i += 2) {
+            simde__m256i k = simde_mm256_loadu_si256(reinterpret_cast<const simde__m256i *>(keys[i].bytes));
+            uint32_t mask = simde_mm256_movemask_epi8(simde_mm256_cmpeq_epi8(k, n2));
+
+            if ((mask & 0xFFFF) == 0xFFFF) {
+                return i;
+            }
+
+            if ((mask >> 16) == 0xFFFF) {
+                return i + 1;
+            }
+        }
+
+        if (i < count) {
+            simde__m128i k = simde_mm_load_si128(reinterpret_cast<const simde__m128i *>(keys[i].bytes));
+
+            if (simde_mm_movemask_epi8(simde_mm_cmpeq_epi8(k, n)) == 0xFFFF) {
+                return i;
+            }
+        }
+
+        return NPOS;
+    }
+
+    std::string uuid_table::format(char separator) const {
+        std::string out(keys.size() * (STRING_LENGTH + 1), separator);
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            get(i).str(out.data() + i * (STRING_LENGTH + 1));
+        }
+
+        return out;
+    }
+
+    UUIDv4::UUID uuid_table::get(size_t index) const {
+        return UUIDv4::UUID(std::string(reinterpret_cast<const char *>(keys[index].bytes), sizeof(key::bytes)));
+    }
+
+    size_t uuid_table::size() const {
+        return keys.size();
+    }
+}
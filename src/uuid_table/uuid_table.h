@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <uuid_v4.h>
+
+namespace obd2_server {
+    // Dense table of 128 bit ids in insertion order, searched with SIMD compares.
+    // Keys are kept in the byte form of UUIDv4::UUID::bytes().
+    class uuid_table {
+        public:
+            static constexpr size_t NPOS = SIZE_MAX;
+            static constexpr size_t STRING_LENGTH = 36;
+
+        private:
+            struct alignas(16) key {
+                uint8_t bytes[16];
+            };
+
+            std::vector<key> keys;
+
+            size_t find(const key &needle) const;
+
+        public:
+            uuid_table();
+            // ids in byte form
+            uuid_table(const std::vector<std::string> &ids);
+
+            void push_back(const UUIDv4::UUID &id);
+            void push_back(const std::string &bytes);
+            void erase(size_t index);
+            void clear();
+
+            // Index of an id, NPOS if it is not in the table
+            size_t find(const UUIDv4::UUID &id) const;
+            size_t find_bytes(std::string_view bytes) const;
+            // Parses a UUID string, NPOS if it is malformed or not in the table
+            size_t find_string(std::string_view uuid) const;
+
+            // Whether a string is a UUID in the 8-4-4-4-12 hex digit form
+            static bool is_string(std::string_view uuid);
+            // Parses a UUID string, throws std::invalid_argument if it is malformed
+            static UUIDv4::UUID parse(std::string_view uuid);
+
+            // All ids as UUID strings, each followed by separator
+            std::string format(char separator) const;
+
+            UUIDv4::UUID get(size_t index) const;
+            size_t size() const;
+    };
+}
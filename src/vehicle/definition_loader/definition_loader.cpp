@@ -0,0 +1,361 @@
+#include "definition_loader.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string_view>
+#include "../vehicle.h"
+
+namespace obd2_server {
+    static constexpr std::array<std::string_view, 4> ROOT_KEYS = { "id", "make", "model", "requests" };
+    static constexpr size_t ROOT_REQUESTS = 3;
+    static constexpr uint32_t ROOT_REQUIRED = (1 << ROOT_KEYS.size()) - 1;
+
+    // Texts first, then numbers, the trailing min and max are optional
+    static constexpr std::array<std::string_view, 11> REQUEST_KEYS = { 
+        "id", "name", "description", "category", "formula", "unit", "ecu", "service", "pid", "min", "max" 
+    };
+    static constexpr size_t REQUEST_STRINGS = 6;
+    static constexpr uint32_t REQUEST_REQUIRED = (1 << 9) - 1;
+
+    template <size_t N>
+    static size_t key_index(const std::array<std::string_view, N> &keys, std::string_view key) {
+        return std::find(keys.begin(), keys.end(), key) - keys.begin();
+    }
+
+    definition_loader::definition_loader(vehicle &target) : target(target) { }
+
+    bool definition_loader::null() {
+        return scalar(nullptr);
+    }
+
+    bool definition_loader::boolean(bool val) {
+        return scalar(val);
+    }
+
+    bool definition_loader::number_integer(number_integer_t val) {
+        if (current == state::request && request_field >= REQUEST_STRINGS && request_field < REQUEST_KEYS.size()) {
+            set_request_number(val);
+            return true;
+        }
+
+        return scalar(val);
+    }
+
+    bool definition_loader::number_unsigned(number_unsigned_t val) {
+        if (current == state::request && request_field >= REQUEST_STRINGS && request_field < REQUEST_KEYS.size()) {
+            set_request_number(val);
+            return true;
+        }
+
+        return scalar(val);
+    }
+
+    bool definition_loader::number_float(number_float_t val, const string_t &) {
+        if (current == state::request && request_field >= REQUEST_STRINGS && request_field < REQUEST_KEYS.size()) {
+            set_request_number(val);
+            return true;
+        }
+
+        return scalar(val);
+    }
+
+    bool definition_loader::string(string_t &val) {
+        if (current == state::root && root_field < ROOT_REQUESTS) {
+            switch (root_field) {
+                case 0:
+                    if (!uuid_table::is_string(val)) {
+                        fail("Malformed vehicle id " + val);
+                    }
+
+                    target.id = UUIDv4::UUID::fromStrFactory(val);
+                    break;
+                case 1:
+                    target.make = val;
+                    break;
+                default:
+                    target.model = val;
+                    break;
+            }
+
+            root_fields |= 1 << root_field;
+            return true;
+        }
+
+        if (current == state::request && request_field < REQUEST_STRINGS) {
+            if (request_field == 0) {
+                if (!uuid_table::is_string(val)) {
+                    fail("Malformed id " + val);
+                }
+
+                current_request->id = UUIDv4::UUID::fromStrFactory(val);
+                request_fields |= 1;
+                return true;
+            }
+
+            switch (request_field) {
+                case 1:
+                    current_request->name = target.strings->store(val);
+                    break;
+                case 2:
+                    current_request->description = target.strings->intern(val);
+                    break;
+                case 3:
+                    current_request->category = target.strings->intern(val);
+                    break;
+                case 4:
+                    current_request->formula = target.strings->store(val);
+                    break;
+                default:
+                    current_request->unit = target.strings->intern(val);
+                    break;
+            }
+
+            request_fields |= 1 << request_field;
+            return true;
+        }
+
+        return scalar(val);
+    }
+
+    bool definition_loader::binary(binary_t &) {
+        fail("Unexpected binary value");
+    }
+
+    bool definition_loader::start_object(std::size_t) {
+        switch (current) {
+            case state::start:
+                current = state::root;
+                return true;
+            case state::requests:
+                // Built in place, the list never moves its elements
+                current_request = &target.requests.emplace_back(UUIDv4::UUID());
+                request_fields = 0;
+                request_field = REQUEST_KEYS.size();
+                current = state::request;
+                return true;
+            default:
+                return begin_container(nlohmann::json::object());
+        }
+    }
+
+    bool definition_loader::key(string_t &val) {
+        switch (current) {
+            case state::root:
+                root_key = val;
+                root_field = key_index(ROOT_KEYS, val);
+                break;
+            case state::request:
+                request_field = key_index(REQUEST_KEYS, val);
+                break;
+            default:
+                document_key = val;
+                break;
+        }
+
+        return true;
+    }
+
+    bool definition_loader::end_object() {
+        switch (current) {
+            case state::request:
+                finish_request();
+                current = state::requests;
+                return true;
+            case state::root:
+                current = state::done;
+                return true;
+            default:
+                return end_container();
+        }
+    }
+
+    bool definition_loader::start_array(std::size_t) {
+        if (current == state::root && root_field == ROOT_REQUESTS) {
+            root_fields |= 1 << ROOT_REQUESTS;
+            current = state::requests;
+            return true;
+        }
+
+        return begin_container(nlohmann::json::array());
+    }
+
+    bool definition_loader::end_array() {
+        if (current == state::requests) {
+            current = state::root;
+            return true;
+        }
+
+        return end_container();
+    }
+
+    bool definition_loader::parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex) {
+        throw std::invalid_argument(ex.what());
+    }
+
+    void definition_loader::finish() {
+        if ((root_fields & ROOT_REQUIRED) != ROOT_REQUIRED) {
+            for (size_t i = 0; i < ROOT_KEYS.size(); i++) {
+                if (!(root_fields & (1 << i))) {
+                    fail("Definition is missing key " + std::string(ROOT_KEYS[i]));
+                }
+            }
+        }
+
+        target.rebuild_index();
+    }
+
+    bool definition_loader::scalar(nlohmann::json &&value) {
+        switch (current) {
+            case state::document:
+                return add_value(std::move(value));
+            case state::root:
+                if (root_field < ROOT_KEYS.size()) {
+                    fail("Key " + root_key + " has the wrong type");
+                }
+
+                begin_document(std::move(value));
+                return true;
+            case state::request:
+                if (request_field < REQUEST_KEYS.size()) {
+                    fail("Key " + std::string(REQUEST_KEYS[request_field]) + " has the wrong type");
+                }
+
+                // Unknown keys are ignored like before
+                return true;
+            case state::requests:
+                fail("Requests must be objects");
+            default:
+                fail("Definition must be an object");
+        }
+    }
+
+    bool definition_loader::begin_container(nlohmann::json &&value) {
+        switch (current) {
+            case state::document:
+                return add_value(std::move(value));
+            case state::root:
+                if (root_field < ROOT_KEYS.size()) {
+                    fail("Key " + root_key + " has the wrong type");
+                }
+
+                begin_document(std::move(value));
+                return true;
+            case state::request:
+                if (request_field < REQUEST_KEYS.size()) {
+                    fail("Key " + std::string(REQUEST_KEYS[request_field]) + " has the wrong type");
+                }
+
+                begin_document(std::move(value));
+                return true;
+            case state::requests:
+                fail("Requests must be objects");
+            default:
+                fail("Definition must be an object");
+        }
+    }
+
+    void definition_loader::begin_document(nlohmann::json &&value) {
+        document_parent = current;
+        current = state::document;
+        open_values.clear();
+        add_value(std::move(value));
+    }
+
+    bool definition_loader::add_value(nlohmann::json &&value) {
+        bool container = value.is_structured();
+        nlohmann::json *slot;
+
+        if (open_values.empty()) {
+            document = std::move(value);
+            slot = &document;
+        }
+        else if (open_values.back()->is_array()) {
+            open_values.back()->push_back(std::move(value));
+            slot = &open_values.back()->back();
+        }
+        else {
+            slot = &((*open_values.back())[document_key] = std::move(value));
+        }
+
+        if (container) {
+            open_values.push_back(slot);
+        }
+        else if (open_values.empty()) {
+            finish_document();
+        }
+
+        return true;
+    }
+
+    bool definition_loader::end_container() {
+        open_values.pop_back();
+
+        if (open_values.empty()) {
+            finish_document();
+        }
+
+        return true;
+    }
+
+    void definition_loader::set_request_number(double value) {
+        switch (request_field) {
+            case 6:
+                current_request->ecu = value;
+                break;
+            case 7:
+                current_request->service = value;
+                break;
+            case 8:
+                current_request->pid = value;
+                break;
+            case 9:
+                current_request->min = value;
+                break;
+            default:
+                current_request->max = value;
+                break;
+        }
+
+        request_fields |= 1 << request_field;
+    }
+
+    void definition_loader::finish_document() {
+        current = document_parent;
+
+        // Subtrees of unknown keys are dropped
+        if (current == state::root && root_key == "virtual_channels") {
+            for (const auto &c : document) {
+                virtual_channel channel = c.template get<virtual_channel>();
+                target.virtual_channels.emplace_back(channel);
+            }
+        }
+        else if (current == state::root && root_key == "rules") {
+            for (const auto &r : document) {
+                target.rules.emplace_back(r.template get<rule>());
+            }
+        }
+
+        document = nullptr;
+    }
+
+    void definition_loader::finish_request() {
+        if ((request_fields & REQUEST_REQUIRED) != REQUEST_REQUIRED) {
+            for (size_t i = 0; i < REQUEST_KEYS.size(); i++) {
+                if (!(request_fields & (1 << i))) {
+                    fail("Missing key " + std::string(REQUEST_KEYS[i]));
+                }
+            }
+        }
+
+        request_count++;
+    }
+
+    void definition_loader::fail(const std::string &message) const {
+        if (current == state::request) {
+            throw std::invalid_argument("Request " + std::to_string(request_count + 1) + ": " + message);
+        }
+
+        throw std::invalid_argument(message);
+    }
+}
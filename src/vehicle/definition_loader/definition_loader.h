@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include "../request/request.h"
+
+namespace obd2_server {
+    class vehicle;
+
+    // SAX handler reading a definition file straight into a vehicle. Requests are built in
+    // place and their texts go to the string arena of the vehicle, so no document is held.
+    // The small virtual_channels and rules sections are collected as documents and parsed as usual.
+    class definition_loader : public nlohmann::json_sax<nlohmann::json> {
+        private:
+            enum class state {
+                start,
+                root,
+                requests,
+                request,
+                document,
+                done
+            };
+
+            vehicle &target;
+            state current = state::start;
+            // Bit per required key seen so far, keys are indices into the key tables
+            uint32_t root_fields = 0;
+            uint32_t request_fields = 0;
+            size_t root_field = 0;
+            size_t request_field = 0;
+            std::string root_key;
+            request *current_request = nullptr;
+            size_t request_count = 0;
+
+            // Subtree collected as a document, containers are open from front to back
+            nlohmann::json document;
+            std::vector<nlohmann::json *> open_values;
+            std::string document_key;
+            state document_parent = state::root;
+
+            bool scalar(nlohmann::json &&value);
+            bool begin_container(nlohmann::json &&value);
+            void begin_document(nlohmann::json &&value);
+            bool add_value(nlohmann::json &&value);
+            bool end_container();
+            void set_request_number(double value);
+            void finish_document();
+            void finish_request();
+            [[noreturn]] void fail(const std::string &message) const;
+
+        public:
+            definition_loader(vehicle &target);
+
+            bool null() override;
+            bool boolean(bool val) override;
+            bool number_integer(number_integer_t val) override;
+            bool number_unsigned(number_unsigned_t val) override;
+            bool number_float(number_float_t val, const string_t &s) override;
+            bool string(string_t &val) override;
+            bool binary(binary_t &val) override;
+            bool start_object(std::size_t elements) override;
+            bool key(string_t &val) override;
+            bool end_object() override;
+            bool start_array(std::size_t elements) override;
+            bool end_array() override;
+            bool parse_error(std::size_t position, const std::string &last_token, const nlohmann::detail::exception &ex) override;
+
+            // Throws if the definition lacks a required key
+            void finish();
+    };
+}
@@ -1,11 +1,52 @@
 #include "request.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string_view>
+#include "../../uuid_table/uuid_table.h"
+
 namespace obd2_server {
-    request::request() : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()) { }
+    // Units whose values only make sense as whole numbers
+    static constexpr std::array<std::string_view, 3> INTEGRAL_UNITS = { "km", "min", "s" };
+    static constexpr int MAX_PRECISION = 4;
+
+    request::request() 
+        : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()), 
+        category_id(0),
+        min(std::numeric_limits<float>::quiet_NaN()), 
+        max(std::numeric_limits<float>::quiet_NaN()) { }
+
+    request::request(const UUIDv4::UUID &id) 
+        : id(id), 
+        category_id(0),
+        min(std::numeric_limits<float>::quiet_NaN()), 
+        max(std::numeric_limits<float>::quiet_NaN()) { }
 
     bool request::operator==(const request &r) const {
         return id == r.id;
     }
+
+    int request::get_precision() const {
+        return value_precision(unit, min, max);
+    }
+
+    int value_precision(std::string_view unit, float min, float max) {
+        if (std::find(INTEGRAL_UNITS.begin(), INTEGRAL_UNITS.end(), unit) != INTEGRAL_UNITS.end()) {
+            return 0;
+        }
+
+        float span = max - min;
+
+        if (std::isnan(span) || span <= 0) {
+            return -1;
+        }
+
+        // Keep about five significant digits over the whole range
+        int precision = MAX_PRECISION - int(std::floor(std::log10(span)));
+        return std::clamp(precision, 0, MAX_PRECISION);
+    }
     
     void to_json(nlohmann::json& j, const request& r) {
         j = nlohmann::json{
@@ -19,17 +60,33 @@ namespace obd2_server {
             {"formula", r.formula},
             {"unit", r.unit}
         };
+
+        if (!std::isnan(r.min)) {
+            j["min"] = r.min;
+        }
+
+        if (!std::isnan(r.max)) {
+            j["max"] = r.max;
+        }
     }
 
-    void from_json(const nlohmann::json& j, request& r) {
-        r.id = UUIDv4::UUID::fromStrFactory(j.at("id"));
-        r.name = j.at("name");
-        r.description = j.at("description");
-        r.category = j.at("category");
+    void from_json(const nlohmann::json& j, request& r, string_arena &strings) {
+        r.id = uuid_table::parse(j.at("id").get_ref<const std::string &>());
+        r.name = strings.store(j.at("name").get_ref<const std::string &>());
+        r.description = strings.intern(j.at("description").get_ref<const std::string &>());
+        r.category = strings.intern(j.at("category").get_ref<const std::string &>());
         r.ecu = j.at("ecu");
         r.service = j.at("service");
         r.pid = j.at("pid");
-        r.formula = j.at("formula");
-        r.unit = j.at("unit");
+        r.formula = strings.store(j.at("formula").get_ref<const std::string &>());
+        r.unit = strings.intern(j.at("unit").get_ref<const std::string &>());
+
+        if (j.contains("min")) {
+            r.min = j.at("min");
+        }
+
+        if (j.contains("max")) {
+            r.max = j.at("max");
+        }
     }
-}
\ No newline at end of file
+}
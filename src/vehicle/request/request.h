@@ -1,29 +1,50 @@
 #pragma once
 
 #include <cstdint>
+#include <string_view>
 #include <uuid_v4.h>
 #include <json.hpp>
+#include "../../string_arena/string_arena.h"
 
 namespace obd2_server {
     class request {
         public:    
             UUIDv4::UUID id;
 
-            std::string name;
-            std::string description;
-            std::string category;
+            // Texts point into the string arena of the owning vehicle, the repetitive
+            // description, category and unit are interned
+            std::string_view name;
+            std::string_view description;
+            std::string_view category;
+            // Index into the categories of the owning vehicle, assigned when it is added
+            uint32_t category_id;
         
             uint32_t ecu;
             uint8_t service;
             uint16_t pid;
-            std::string formula;
-            std::string unit;   
+            std::string_view formula;
+            std::string_view unit;   
+
+            // Optional value range, NaN if not given in the definition
+            float min;
+            float max;
 
             request();
+            explicit request(const UUIDv4::UUID &id);
+            // Only views and an id, copies cannot throw
+            request(const request &r) noexcept = default;
+            request &operator=(const request &r) noexcept = default;
 
             bool operator==(const request &r) const;
+
+            // Number of decimals worth logging for this value, -1 for shortest round-trip
+            int get_precision() const;
     };
     
+    // Decimals worth logging for a value of this unit and range, -1 for shortest round-trip
+    int value_precision(std::string_view unit, float min, float max);
+
     void to_json(nlohmann::json& j, const request& p);
-    void from_json(const nlohmann::json& j, request& p);
+    // Texts are copied into strings, which must outlive the request
+    void from_json(const nlohmann::json& j, request& p, string_arena &strings);
 }
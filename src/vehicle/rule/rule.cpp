@@ -0,0 +1,46 @@
+#include "rule.h"
+
+#include <stdexcept>
+
+namespace obd2_server {
+    static const uint32_t DEFAULT_CAPTURE_MS = 10000;
+
+    rule::rule() : for_ms(0), action(rule_action::message), capture_ms(DEFAULT_CAPTURE_MS) { }
+
+    void to_json(nlohmann::json& j, const rule& r) {
+        static const char *ACTION_NAMES[] = { "marker", "stderr", "capture" };
+
+        j = nlohmann::json{
+            {"name", r.name},
+            {"condition", r.condition},
+            {"for_ms", r.for_ms},
+            {"action", ACTION_NAMES[static_cast<int>(r.action)]}
+        };
+
+        if (r.action == rule_action::capture) {
+            j["capture_ms"] = r.capture_ms;
+        }
+    }
+
+    void from_json(const nlohmann::json& j, rule& r) {
+        r.name = j.at("name");
+        r.condition = j.at("condition");
+        r.for_ms = j.value("for_ms", 0);
+        r.capture_ms = j.value("capture_ms", DEFAULT_CAPTURE_MS);
+
+        std::string action = j.value("action", "stderr");
+
+        if (action == "marker") {
+            r.action = rule_action::marker;
+        }
+        else if (action == "stderr") {
+            r.action = rule_action::message;
+        }
+        else if (action == "capture") {
+            r.action = rule_action::capture;
+        }
+        else {
+            throw std::invalid_argument("Unknown action " + action + " in rule " + r.name);
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <json.hpp>
+
+namespace obd2_server {
+    enum class rule_action {
+        marker,
+        message,
+        capture
+    };
+
+    // Fires its action once the condition over channel values ([name] or [uuid]) held for for_ms
+    class rule {
+        public:
+            std::string name;
+            std::string condition;
+            uint32_t for_ms;
+            rule_action action;
+            // Length of a triggered raw capture
+            uint32_t capture_ms;
+
+            rule();
+    };
+
+    void to_json(nlohmann::json& j, const rule& r);
+    void from_json(const nlohmann::json& j, rule& r);
+}
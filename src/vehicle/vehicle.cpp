@@ -3,31 +3,49 @@
 #include <exception>
 #include <fstream>
 #include <json.hpp>
+#include "definition_loader/definition_loader.h"
 
 namespace obd2_server {
-    vehicle::vehicle() : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()) { }
+    vehicle::vehicle() 
+        : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()), strings(std::make_shared<string_arena>()) { }
 
+    // Streams the file, so peak memory follows the size of the vehicle instead of the document
     vehicle::vehicle(const std::string &definition_file)
-        : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()) {
+        : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()), strings(std::make_shared<string_arena>()) {
         std::ifstream file(definition_file);
 
         if (!file.is_open()) {
             throw std::invalid_argument("Could not open file");
         }
 
-        nlohmann::json j;
-        try {
-            j = nlohmann::json::parse(file);
-        }
-        catch (std::exception &e) {
-            throw std::invalid_argument(e.what());
-        }
-
-        from_json(j, *this);
+        definition_loader loader(*this);
+        nlohmann::json::sax_parse(file, &loader);
+        loader.finish();
     }
 
     vehicle::vehicle(const std::string &make, const std::string &model)
-        : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()), make(make), model(model) { }
+        : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()), make(make), model(model), strings(std::make_shared<string_arena>()) { }
+
+    // The index points into the list, so copies index their own list
+    vehicle::vehicle(const vehicle &v) 
+        : id(v.id), make(v.make), model(v.model), requests(v.requests), virtual_channels(v.virtual_channels), rules(v.rules), strings(v.strings) {
+        rebuild_index();
+    }
+
+    vehicle &vehicle::operator=(const vehicle &v) {
+        if (this != &v) {
+            id = v.id;
+            make = v.make;
+            model = v.model;
+            requests = v.requests;
+            virtual_channels = v.virtual_channels;
+            rules = v.rules;
+            strings = v.strings;
+            rebuild_index();
+        }
+
+        return *this;
+    }
 
     bool vehicle::operator==(const vehicle &v) const {
         return id == v.id;
@@ -35,14 +53,65 @@ namespace obd2_server {
 
     void vehicle::add_request(const request &r) {
         requests.push_back(r);
+        request &added = requests.back();
+
+        // The texts of r may live elsewhere, the vehicle keeps its own copies
+        added.name = strings->store(r.name);
+        added.description = strings->intern(r.description);
+        added.category = strings->intern(r.category);
+        added.formula = strings->store(r.formula);
+        added.unit = strings->intern(r.unit);
+
+        request_ids.push_back(r.id);
+        request_refs.push_back(&added);
+        index_category(added);
     }
 
     void vehicle::remove_request(const request &r) {
         auto element = std::find(requests.begin(), requests.end(), r);
+        size_t index = request_ids.find(r.id);
+
+        if (index != uuid_table::NPOS) {
+            request_ids.erase(index);
+            request_refs.erase(request_refs.begin() + index);
+        }
+
+        if (element != requests.end()) {
+            std::vector<const request *> &members = category_requests[element->category_id];
+            members.erase(std::find(members.begin(), members.end(), &*element));
+        }
         
         requests.erase(element);
     }
 
+    void vehicle::rebuild_index() {
+        request_ids.clear();
+        request_refs.clear();
+
+        categories.clear();
+        category_requests.clear();
+
+        for (request &r : requests) {
+            request_ids.push_back(r.id);
+            request_refs.push_back(&r);
+            index_category(r);
+        }
+    }
+
+    void vehicle::index_category(request &r) {
+        // Vehicles have few categories, so a scan beats hashing here
+        uint32_t id = find_category(r.category);
+
+        if (id == NO_CATEGORY) {
+            id = categories.size();
+            categories.push_back(r.category);
+            category_requests.emplace_back();
+        }
+
+        r.category_id = id;
+        category_requests[id].push_back(&r);
+    }
+
     const UUIDv4::UUID &vehicle::get_id() const {
         return id;
     }
@@ -56,19 +125,40 @@ namespace obd2_server {
     }
 
     const request &vehicle::get_request(const UUIDv4::UUID &id) const {
-        for (const auto &r : requests) {
-            if (r.id == id) {
-                return r;
-            }
+        size_t index = request_ids.find(id);
+
+        if (index == uuid_table::NPOS) {
+            throw std::invalid_argument("Request not found");
         }
 
-        throw std::invalid_argument("Request not found");
+        return *request_refs[index];
     }
 
     const std::list<request> &vehicle::get_requests() const {
         return requests;
     }
 
+    const std::vector<std::string_view> &vehicle::get_categories() const {
+        return categories;
+    }
+
+    uint32_t vehicle::find_category(std::string_view category) const {
+        auto it = std::find(categories.begin(), categories.end(), category);
+        return it == categories.end() ? NO_CATEGORY : it - categories.begin();
+    }
+
+    const std::vector<const request *> &vehicle::get_category_requests(uint32_t category_id) const {
+        return category_requests.at(category_id);
+    }
+
+    const std::list<virtual_channel> &vehicle::get_virtual_channels() const {
+        return virtual_channels;
+    }
+
+    const std::list<rule> &vehicle::get_rules() const {
+        return rules;
+    }
+
     void to_json(nlohmann::json& j, const vehicle& v) {
         j = nlohmann::json{
             {"id", v.id.str()},
@@ -76,16 +166,38 @@ namespace obd2_server {
             {"model", v.model},
             {"requests", v.requests}
         };
+
+        if (!v.virtual_channels.empty()) {
+            j["virtual_channels"] = v.virtual_channels;
+        }
+
+        if (!v.rules.empty()) {
+            j["rules"] = v.rules;
+        }
     }
 
     void from_json(const nlohmann::json& j, vehicle& v) {
-        v.id = UUIDv4::UUID::fromStrFactory(j.at("id"));
+        v.id = uuid_table::parse(j.at("id").get_ref<const std::string &>());
         v.make = j.at("make");
         v.model = j.at("model");
 
         for (const auto &r : j.at("requests")) {
-            request req = r.template get<request>();
-            v.requests.emplace_back(req);
+            from_json(r, v.requests.emplace_back(UUIDv4::UUID()), *v.strings);
         }
+
+        if (j.contains("virtual_channels")) {
+            for (const auto &c : j.at("virtual_channels")) {
+                virtual_channel channel = c.template get<virtual_channel>();
+                v.virtual_channels.emplace_back(channel);
+            }
+        }
+
+        if (j.contains("rules")) {
+            for (const auto &r : j.at("rules")) {
+                v.rules.emplace_back(r.template get<rule>());
+            }
+        }
+
+        v.rebuild_index();
     }
 }
@@ -2,8 +2,15 @@
 
 #include <cstdint>
 #include <list>
+#include <memory>
+#include <string_view>
+#include <vector>
 #include <uuid_v4.h>
 #include "request/request.h"
+#include "virtual_channel/virtual_channel.h"
+#include "rule/rule.h"
+#include "../uuid_table/uuid_table.h"
+#include "../string_arena/string_arena.h"
 
 namespace obd2_server {
     class vehicle {
@@ -13,11 +20,34 @@ namespace obd2_server {
             std::string make;
             std::string model;
             std::list<request> requests;
+            std::list<virtual_channel> virtual_channels;
+            std::list<rule> rules;
+
+            // Backs the texts of the requests, copies of the vehicle share it
+            std::shared_ptr<string_arena> strings;
+
+            // Request ids in list order, for lookups without walking the list
+            uuid_table request_ids;
+            std::vector<const request *> request_refs;
+
+            // Distinct categories in order of appearance and their requests in list order
+            std::vector<std::string_view> categories;
+            std::vector<std::vector<const request *>> category_requests;
+
+            void rebuild_index();
+            void index_category(request &r);
 
         public:
+            static constexpr uint32_t NO_CATEGORY = UINT32_MAX;
+
             vehicle();
             vehicle(const std::string &definition_file);
             vehicle(const std::string &make, const std::string &model);
+            vehicle(const vehicle &v);
+            vehicle(vehicle &&v) = default;
+
+            vehicle &operator=(const vehicle &v);
+            vehicle &operator=(vehicle &&v) = default;
 
             bool operator==(const vehicle &v) const;
 
@@ -29,7 +59,14 @@ namespace obd2_server {
             std::string get_model() const;
             const request &get_request(const UUIDv4::UUID &id) const;
             const std::list<request> &get_requests() const;
+            const std::vector<std::string_view> &get_categories() const;
+            // Id of a category for request::category_id, NO_CATEGORY if no request has it
+            uint32_t find_category(std::string_view category) const;
+            const std::vector<const request *> &get_category_requests(uint32_t category_id) const;
+            const std::list<virtual_channel> &get_virtual_channels() const;
+            const std::list<rule> &get_rules() const;
 
+            friend class definition_loader;
             friend void to_json(nlohmann::json& j, const vehicle& v);
             friend void from_json(const nlohmann::json& j, vehicle& v);
     };
@@ -0,0 +1,57 @@
+#include "virtual_channel.h"
+
+#include <cmath>
+#include <limits>
+#include "../request/request.h"
+#include "../../uuid_table/uuid_table.h"
+
+namespace obd2_server {
+    virtual_channel::virtual_channel() 
+        : id(UUIDv4::UUIDGenerator<std::mt19937>().getUUID()), 
+        min(std::numeric_limits<float>::quiet_NaN()), 
+        max(std::numeric_limits<float>::quiet_NaN()) { }
+
+    bool virtual_channel::operator==(const virtual_channel &c) const {
+        return id == c.id;
+    }
+
+    int virtual_channel::get_precision() const {
+        return value_precision(unit, min, max);
+    }
+
+    void to_json(nlohmann::json& j, const virtual_channel& c) {
+        j = nlohmann::json{
+            {"id", c.id.str()}, 
+            {"name", c.name},
+            {"description", c.description},
+            {"category", c.category},
+            {"formula", c.formula},
+            {"unit", c.unit}
+        };
+
+        if (!std::isnan(c.min)) {
+            j["min"] = c.min;
+        }
+
+        if (!std::isnan(c.max)) {
+            j["max"] = c.max;
+        }
+    }
+
+    void from_json(const nlohmann::json& j, virtual_channel& c) {
+        c.id = uuid_table::parse(j.at("id").get_ref<const std::string &>());
+        c.name = j.at("name");
+        c.description = j.value("description", "");
+        c.category = j.value("category", "");
+        c.formula = j.at("formula");
+        c.unit = j.value("unit", "");
+
+        if (j.contains("min")) {
+            c.min = j.at("min");
+        }
+
+        if (j.contains("max")) {
+            c.max = j.at("max");
+        }
+    }
+}
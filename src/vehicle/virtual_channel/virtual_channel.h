@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <uuid_v4.h>
+#include <json.hpp>
+
+namespace obd2_server {
+    // Channel computed from other channels instead of being requested from the bus.
+    // The formula refers to requests and other virtual channels as [name] or [uuid].
+    class virtual_channel {
+        public:
+            UUIDv4::UUID id;
+
+            std::string name;
+            std::string description;
+            std::string category;
+            std::string formula;
+            std::string unit;
+
+            // Optional value range, NaN if not given in the definition
+            float min;
+            float max;
+
+            virtual_channel();
+
+            bool operator==(const virtual_channel &c) const;
+
+            int get_precision() const;
+    };
+
+    void to_json(nlohmann::json& j, const virtual_channel& c);
+    void from_json(const nlohmann::json& j, virtual_channel& c);
+}
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include "../src/formula/formula.h"
+
+// Generates standard_decoders.h from obd_standard.json. Every Service 01 formula of the engine
+// ECU becomes a specialization of decode<PID, CHANNEL> with the same float operations in the same
+// order as the formula engine, so both decode bit for bit alike. Formulas using anything but
+// arithmetic are left to the engine.
+
+static std::string float_literal(float value) {
+    char buffer[32];
+    std::to_chars_result res = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    std::string literal(buffer, res.ptr);
+
+    if (literal.find_first_of(".en") == std::string::npos) {
+        literal += ".0";
+    }
+
+    return literal + "f";
+}
+
+// Turns the postfix program into a fully parenthesized expression, empty if it cannot
+static std::string to_expression(const obd2_server::formula &f) {
+    using opcode = obd2_server::formula::opcode;
+    std::vector<std::string> stack;
+
+    for (const obd2_server::formula::instruction &ins : f.get_program()) {
+        switch (ins.op) {
+            case opcode::push_const:
+                stack.push_back(float_literal(ins.value));
+                break;
+            case opcode::push_byte:
+                stack.push_back("float(data[" + std::to_string(unsigned(ins.index)) + "])");
+                break;
+            case opcode::neg:
+                stack.back() = "(-" + stack.back() + ")";
+                break;
+            case opcode::add:
+            case opcode::sub:
+            case opcode::mul:
+            case opcode::div: {
+                const char *symbol = ins.op == opcode::add ? " + " : ins.op == opcode::sub ? " - " : ins.op == opcode::mul ? " * " : " / ";
+                std::string b = stack.back();
+                stack.pop_back();
+                stack.back() = "(" + stack.back() + symbol + b + ")";
+                break;
+            }
+            default:
+                return "";
+        }
+    }
+
+    return stack.size() == 1 ? stack.back() : "";
+}
+
+static std::string hex_byte(unsigned value) {
+    char buffer[8];
+    std::to_chars_result res = std::to_chars(buffer, buffer + sizeof(buffer), value, 16);
+    std::string digits(buffer, res.ptr);
+    return "0x" + std::string(2 - std::min<size_t>(digits.size(), 2), '0') + digits;
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " obd_standard.json output.h" << std::endl;
+        return 1;
+    }
+
+    nlohmann::json definition;
+
+    try {
+        std::ifstream file(argv[1]);
+        definition = nlohmann::json::parse(file);
+    }
+    catch (std::exception &e) {
+        std::cerr << "Cannot read " << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    struct decoder {
+        unsigned pid;
+        size_t channel;
+        std::string formula;
+        std::string expression;
+        size_t required_bytes;
+    };
+
+    std::map<unsigned, std::vector<decoder>> pids;
+    std::map<unsigned, std::vector<std::string>> seen;
+
+    for (const nlohmann::json &r : definition.at("requests")) {
+        if (r.at("ecu") != 0x7E0 || r.at("service") != 0x01) {
+            continue;
+        }
+
+        unsigned pid = r.at("pid");
+        std::string formula = r.at("formula");
+        std::vector<std::string> &formulas = seen[pid];
+
+        // Channels of a PID are told apart by their formula
+        if (pid > 0xFF || std::find(formulas.begin(), formulas.end(), formula) != formulas.end()) {
+            continue;
+        }
+
+        obd2_server::formula compiled;
+
+        try {
+            compiled = obd2_server::formula(formula);
+        }
+        catch (std::exception &e) {
+            std::cerr << "Skipping PID " << pid << ": " << e.what() << std::endl;
+            continue;
+        }
+
+        std::string expression = to_expression(compiled);
+
+        if (expression.empty()) {
+            continue;
+        }
+
+        formulas.push_back(formula);
+        pids[pid].push_back({ pid, pids[pid].size(), formula, expression, compiled.get_required_bytes() });
+    }
+
+    std::ofstream out(argv[2]);
+
+    out << "// Generated from obd_standard.json by tools/gen_standard_decoders, do not edit\n"
+        << "#pragma once\n\n"
+        << "#include <array>\n#include <cstddef>\n#include <cstdint>\n#include <limits>\n#include <string_view>\n\n"
+        << "namespace obd2_server::standard_decoders {\n"
+        << "    using decode_fn = float (*)(const uint8_t *data, size_t size);\n\n"
+        << "    // CHANNEL tells apart the values of a PID in definition order\n"
+        << "    template <uint8_t PID, size_t CHANNEL>\n"
+        << "    constexpr float decode(const uint8_t *data, size_t size);\n";
+
+    size_t entry_count = 0;
+
+    for (const auto &[pid, decoders] : pids) {
+        for (const decoder &d : decoders) {
+            out << "\n    // " << d.formula << "\n"
+                << "    template <>\n"
+                << "    constexpr float decode<" << hex_byte(pid) << ", " << d.channel << ">(const uint8_t *data, size_t size) {\n"
+                << "        if (size < " << d.required_bytes << ") {\n"
+                << "            return std::numeric_limits<float>::quiet_NaN();\n"
+                << "        }\n\n"
+                << "        return " << (d.required_bytes == 0 ? "(void)data, " : "") << d.expression << ";\n"
+                << "    }\n";
+            entry_count++;
+        }
+    }
+
+    out << "\n    struct entry {\n"
+        << "        std::string_view formula;\n"
+        << "        decode_fn decode;\n"
+        << "    };\n\n"
+        << "    // Decoders ordered by PID\n"
+        << "    inline constexpr std::array<entry, " << entry_count << "> ENTRIES = {{\n";
+
+    for (const auto &[pid, decoders] : pids) {
+        for (const decoder &d : decoders) {
+            out << "        { " << nlohmann::json(d.formula).dump() << ", decode<" << hex_byte(pid) << ", " << d.channel << "> },\n";
+        }
+    }
+
+    out << "    }};\n\n"
+        << "    struct slot {\n"
+        << "        uint16_t first;\n"
+        << "        uint16_t count;\n"
+        << "    };\n\n"
+        << "    // Entries of every PID byte, indexed by the PID\n"
+        << "    inline constexpr std::array<slot, 256> PIDS = {{\n";
+
+    size_t first = 0;
+
+    for (unsigned pid = 0; pid <= 0xFF; pid++) {
+        auto it = pids.find(pid);
+        size_t count = it == pids.end() ? 0 : it->second.size();
+
+        out << "        { " << first << ", " << count << " },\n";
+        first += count;
+    }
+
+    out << "    }};\n\n"
+        << "    // Generated decoder of a standard PID with this formula, nullptr if there is none\n"
+        << "    constexpr decode_fn find(uint8_t pid, std::string_view formula) {\n"
+        << "        const slot &s = PIDS[pid];\n\n"
+        << "        for (size_t i = s.first; i < size_t(s.first) + s.count; i++) {\n"
+        << "            if (ENTRIES[i].formula == formula) {\n"
+        << "                return ENTRIES[i].decode;\n"
+        << "            }\n"
+        << "        }\n\n"
+        << "        return nullptr;\n"
+        << "    }\n\n"
+        << "    // CHANNEL of the decoder of a standard PID with this formula, SIZE_MAX if there is none\n"
+        << "    constexpr size_t find_channel(uint8_t pid, std::string_view formula) {\n"
+        << "        const slot &s = PIDS[pid];\n\n"
+        << "        for (size_t i = s.first; i < size_t(s.first) + s.count; i++) {\n"
+        << "            if (ENTRIES[i].formula == formula) {\n"
+        << "                return i - s.first;\n"
+        << "            }\n"
+        << "        }\n\n"
+        << "        return SIZE_MAX;\n"
+        << "    }\n\n"
+        << "    // Decodes with decode<PID, CHANNEL> through direct calls, for decode loops that would otherwise\n"
+        << "    // call through a pointer. NaN for a PID and channel without a decoder.\n"
+        << "    constexpr float decode(uint8_t pid, size_t channel, const uint8_t *data, size_t size) {\n"
+        << "        switch (size_t(pid) << 8 | channel) {\n";
+
+    for (const auto &[pid, decoders] : pids) {
+        for (const decoder &d : decoders) {
+            out << "            case " << hex_byte(pid) << hex_byte(unsigned(d.channel)).substr(2) << ": return decode<" << hex_byte(pid) << ", " << d.channel << ">(data, size);\n";
+        }
+    }
+
+    out << "            default: return std::numeric_limits<float>::quiet_NaN();\n"
+        << "        }\n"
+        << "    }\n"
+        << "}\n";
+
+    if (!out) {
+        std::cerr << "Cannot write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    return 0;
+}